@@ -0,0 +1,863 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <memory>
+#ifdef CHUNK_ALLOCATOR_CHECKED
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#endif
+#include <memory_resource>
+#include <new>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Building with CHUNK_ALLOCATOR_CHECKED defined turns on the checked mode:
+ * block headers carry a canary, every block is followed by guard bytes,
+ * freed memory is poisoned, double and invalid frees abort, and blocks still
+ * live when their AllocationMemory is destroyed are reported as leaks.
+ * Without the macro none of this code is compiled. */
+#ifdef CHUNK_ALLOCATOR_CHECKED
+[[noreturn]] inline void reportHeapCorruption(const char *what,
+                                              const void *address) {
+  std::fprintf(stderr, "chunk allocator: %s at %p\n", what, address);
+  std::abort();
+}
+#endif
+
+/* Every block is preceded by a HEADER_LENGTH-byte header holding the block
+ * size and, for over-aligned blocks, the padding skipped in front of the
+ * header. The header is as long as the natural alignment, so requests
+ * aligned to 8 or 16 bytes never need padding. */
+class Chunk {
+public:
+  static constexpr std::size_t HEADER_LENGTH = alignof(std::max_align_t);
+  static constexpr std::size_t NATURAL_ALIGNMENT = HEADER_LENGTH;
+  static_assert(HEADER_LENGTH >= 2 * sizeof(std::uint32_t),
+                "the header holds the block size and padding");
+#ifdef CHUNK_ALLOCATOR_CHECKED
+  static constexpr std::uint32_t BLOCK_IN_USE = 0xA110CA7E;
+  static constexpr std::uint32_t BLOCK_FREE = 0xF4EEB10C;
+  static_assert(HEADER_LENGTH >= 4 * sizeof(std::uint32_t),
+                "checked mode keeps its canary in the fourth header word");
+#endif
+
+private:
+  const std::size_t chunk_size;
+  std::pmr::memory_resource *upstream;
+  std::uint8_t *storage;
+
+  /* Free blocks by address, to find a block's neighbours, and by (size,
+   * address), to find the smallest block that fits in O(log n). */
+  std::set<std::uint32_t *> free_blocks;
+  std::set<std::pair<std::uint32_t, std::uint32_t *>> free_sizes;
+
+public:
+  Chunk(std::size_t size, std::pmr::memory_resource *upstream)
+      : chunk_size{size}, upstream{upstream},
+        storage{static_cast<std::uint8_t *>(
+            upstream->allocate(chunk_size, NATURAL_ALIGNMENT))} {
+    auto *pointer_header = reinterpret_cast<std::uint32_t *>(storage);
+
+    setHeader(pointer_header, chunk_size - HEADER_LENGTH, 0);
+    addFreeBlock(pointer_header);
+  }
+
+  Chunk(const Chunk &) = delete;
+  Chunk &operator=(const Chunk &) = delete;
+
+  ~Chunk() { upstream->deallocate(storage, chunk_size, NATURAL_ALIGNMENT); }
+
+  bool contains(const std::uint8_t *address) const noexcept {
+    const auto *start_chunk = storage;
+    const auto *end_chunk = start_chunk + chunk_size;
+    return (start_chunk <= address) && (address < end_chunk);
+  }
+
+  std::size_t size() const noexcept { return chunk_size; }
+
+  std::uint8_t *data() noexcept { return storage; }
+
+  /* allocation_size must be a multiple of NATURAL_ALIGNMENT and alignment a
+   * power of two. */
+  std::uint8_t *reserveBlock(std::size_t allocation_size,
+                             std::size_t alignment = NATURAL_ALIGNMENT) {
+    assert(isPowerOfTwo(alignment));
+    const std::size_t alloc_size_req =
+        requiredFreeBlock(allocation_size, alignment);
+
+    if (alloc_size_req > largestFreeBlock()) {
+      return nullptr;
+    }
+
+    const auto best_fit = free_sizes.lower_bound(
+        {static_cast<std::uint32_t>(alloc_size_req), nullptr});
+
+    std::uint32_t *free_header = best_fit->second;
+    const std::uint32_t old_block_size = *free_header;
+
+    auto *block_start = reinterpret_cast<std::uint8_t *>(free_header);
+    const auto user_address =
+        (reinterpret_cast<std::uintptr_t>(block_start) + HEADER_LENGTH +
+         alignment - 1) &
+        ~(static_cast<std::uintptr_t>(alignment) - 1);
+    const std::size_t padding = user_address -
+                                reinterpret_cast<std::uintptr_t>(block_start) -
+                                HEADER_LENGTH;
+    std::size_t consumed = padding + allocation_size;
+
+    if (old_block_size - consumed >= HEADER_LENGTH) {
+      auto *new_header_address = reinterpret_cast<std::uint32_t *>(
+          block_start + HEADER_LENGTH + consumed);
+      setHeader(new_header_address,
+                old_block_size - consumed - HEADER_LENGTH, 0);
+      moveFreeBlock(old_block_size, free_header, new_header_address);
+    } else {
+      removeFreeBlock(free_header);
+      consumed = old_block_size;
+    }
+
+    auto *header_address =
+        reinterpret_cast<std::uint32_t *>(block_start + padding);
+    setHeader(header_address, consumed - padding, padding);
+#ifdef CHUNK_ALLOCATOR_CHECKED
+    header_address[3] = BLOCK_IN_USE;
+#endif
+
+    return reinterpret_cast<std::uint8_t *>(header_address) + HEADER_LENGTH;
+  }
+
+  /* Returns the block to the free set, merged with the free blocks right
+   * before and after it, so that no two free blocks are ever adjacent. */
+  void releaseBlock(std::uint8_t *block_ptr) {
+    auto *header_address =
+        reinterpret_cast<std::uint32_t *>(block_ptr - HEADER_LENGTH);
+#ifdef CHUNK_ALLOCATOR_CHECKED
+    if (header_address[3] != BLOCK_IN_USE) {
+      reportHeapCorruption("corrupted block header", block_ptr);
+    }
+    header_address[3] = BLOCK_FREE;
+#endif
+    const std::uint32_t padding = header_address[1];
+
+    if (padding) {
+      auto *block_start = reinterpret_cast<std::uint32_t *>(
+          reinterpret_cast<std::uint8_t *>(header_address) - padding);
+      setHeader(block_start, header_address[0] + padding, 0);
+      header_address = block_start;
+    }
+
+    /* free_blocks is ordered by address: the first entry past the block is
+     * its successor if that is free, and the entry before it its
+     * predecessor. A merge reuses the entries of a neighbour. */
+    const auto next = free_blocks.lower_bound(header_address);
+    std::uint32_t *successor =
+        ((next != free_blocks.end()) && (*next == blockEnd(header_address)))
+            ? *next
+            : nullptr;
+    std::uint32_t *previous = ((next != free_blocks.begin()) &&
+                               (blockEnd(*std::prev(next)) == header_address))
+                                  ? *std::prev(next)
+                                  : nullptr;
+
+    if (previous) {
+      const std::uint32_t old_size = previous[0];
+      previous[0] += HEADER_LENGTH + header_address[0];
+      if (successor) {
+        previous[0] += HEADER_LENGTH + successor[0];
+        removeFreeBlock(successor);
+      }
+      moveFreeBlock(old_size, previous, previous);
+    } else if (successor) {
+      header_address[0] += HEADER_LENGTH + successor[0];
+      moveFreeBlock(successor[0], successor, header_address);
+    } else {
+      addFreeBlock(header_address);
+    }
+  }
+
+  std::size_t freeBytes() const noexcept {
+    std::size_t free_bytes = 0;
+    for (const auto *header : free_blocks) {
+      free_bytes += *header;
+    }
+    return free_bytes;
+  }
+
+  std::size_t largestFreeBlock() const noexcept {
+    return free_sizes.empty() ? 0 : free_sizes.rbegin()->first;
+  }
+
+  /* The smallest free block that reserveBlock can always carve such a block
+   * from, whatever the address of the free block. */
+  static std::size_t requiredFreeBlock(std::size_t allocation_size,
+                                       std::size_t alignment) noexcept {
+    return allocation_size +
+           ((alignment > NATURAL_ALIGNMENT) ? (alignment - NATURAL_ALIGNMENT)
+                                            : 0);
+  }
+
+  static bool isPowerOfTwo(std::size_t value) noexcept {
+    return (value != 0) && ((value & (value - 1)) == 0);
+  }
+
+private:
+  void addFreeBlock(std::uint32_t *header) {
+    free_blocks.insert(header);
+    free_sizes.emplace(header[0], header);
+  }
+
+  void removeFreeBlock(std::uint32_t *header) {
+    free_blocks.erase(header);
+    free_sizes.erase({header[0], header});
+  }
+
+  /* Rekeys the entries of the free block that was old_size bytes at
+   * old_header to the one now at new_header, reusing their tree nodes. */
+  void moveFreeBlock(std::uint32_t old_size, std::uint32_t *old_header,
+                     std::uint32_t *new_header) {
+    if (old_header != new_header) {
+      auto by_address = free_blocks.extract(old_header);
+      by_address.value() = new_header;
+      free_blocks.insert(std::move(by_address));
+    }
+    auto by_size = free_sizes.extract({old_size, old_header});
+    by_size.value() = {new_header[0], new_header};
+    free_sizes.insert(std::move(by_size));
+  }
+
+  static std::uint32_t *blockEnd(std::uint32_t *header) noexcept {
+    return reinterpret_cast<std::uint32_t *>(
+        reinterpret_cast<std::uint8_t *>(header) + HEADER_LENGTH + header[0]);
+  }
+
+  static void setHeader(std::uint32_t *header, std::size_t size,
+                        std::size_t padding) noexcept {
+    header[0] = static_cast<std::uint32_t>(size);
+    header[1] = static_cast<std::uint32_t>(padding);
+  }
+};
+
+struct AllocationStats {
+  static const std::size_t HISTOGRAM_BUCKETS = 32;
+
+  std::size_t bytes_in_use = 0;
+  std::size_t peak_bytes_in_use = 0;
+  std::size_t chunk_count = 0;
+  std::size_t large_object_count = 0;
+  /* 1 - largest free block / total free bytes, over all chunks */
+  double fragmentation = 0.0;
+  /* bucket i counts requests of [2^i, 2^(i+1)) bytes */
+  std::array<std::size_t, HISTOGRAM_BUCKETS> size_histogram{};
+
+  std::size_t allocate_calls = 0;
+  std::size_t deallocate_calls = 0;
+  std::size_t construct_calls = 0;
+  std::size_t destroy_calls = 0;
+
+  static std::size_t histogramBucket(std::size_t size) noexcept {
+    std::size_t bucket = 0;
+    while ((size >>= 1) && (bucket + 1 < HISTOGRAM_BUCKETS)) {
+      bucket++;
+    }
+    return bucket;
+  }
+};
+
+/* Chunks start at CHUNK_SIZE bytes and double with every new chunk up to
+ * MAX_CHUNK_SIZE. Requests above LARGE_OBJECT_THRESHOLD or aligned to more
+ * than MAX_BLOCK_ALIGNMENT bypass the chunks and get their own allocation,
+ * released as soon as they are deallocated. Chunk storage and large objects
+ * both come from the upstream resource. Block sizes are rounded up to
+ * BLOCK_ALIGNMENT, so headers never break the alignment of the next block. */
+template <std::size_t CHUNK_SIZE> class AllocationMemory {
+public:
+  static constexpr std::size_t MAX_CHUNK_SIZE = CHUNK_SIZE * 64;
+  static constexpr std::size_t LARGE_OBJECT_THRESHOLD = MAX_CHUNK_SIZE / 4;
+  static constexpr std::size_t BLOCK_ALIGNMENT = Chunk::NATURAL_ALIGNMENT;
+  static constexpr std::size_t MAX_BLOCK_ALIGNMENT = 64;
+
+  static_assert(CHUNK_SIZE % BLOCK_ALIGNMENT == 0,
+                "CHUNK_SIZE must be a multiple of the block alignment");
+
+private:
+  std::pmr::memory_resource *upstream;
+  /* chunk start -> chunk, to find the owner of a block in O(log n) */
+  std::map<const std::uint8_t *, Chunk *> chunks_by_address;
+  /* (largest free block, chunk), to find the chunk with the least room that
+   * still fits a request in O(log n) */
+  std::set<std::pair<std::size_t, Chunk *>> chunks_by_space;
+  std::size_t next_chunk_size = CHUNK_SIZE;
+  /* address -> (size, alignment) */
+  std::unordered_map<void *, std::pair<std::size_t, std::size_t>>
+      large_objects;
+
+  bool stats_enabled = false;
+  AllocationStats counters;
+
+#ifdef CHUNK_ALLOCATOR_CHECKED
+  static constexpr std::size_t GUARD_LENGTH = BLOCK_ALIGNMENT;
+  static constexpr std::uint8_t GUARD_BYTE = 0xAB;
+  static constexpr std::uint8_t POISON_BYTE = 0xDD;
+
+  /* address -> requested size */
+  std::unordered_map<void *, std::size_t> live_blocks;
+#endif
+
+public:
+  explicit AllocationMemory(
+      std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : upstream{upstream} {}
+
+  AllocationMemory(const AllocationMemory &) = delete;
+  AllocationMemory &operator=(const AllocationMemory &) = delete;
+
+  ~AllocationMemory() {
+#ifdef CHUNK_ALLOCATOR_CHECKED
+    reportLeaks();
+#endif
+    for (auto &chunk : chunks_by_address) {
+      delete chunk.second;
+    }
+    for (auto &large_object : large_objects) {
+      upstream->deallocate(large_object.first, large_object.second.first,
+                           large_object.second.second);
+    }
+  }
+
+  std::pmr::memory_resource *upstream_resource() const noexcept {
+    return upstream;
+  }
+
+  /* alignment must be a power of two. */
+  void *allocate_object(std::size_t size,
+                        std::size_t alignment = BLOCK_ALIGNMENT) {
+    assert(Chunk::isPowerOfTwo(alignment));
+
+    if (size == 0) {
+      return nullptr;
+    }
+#ifdef CHUNK_ALLOCATOR_CHECKED
+    const std::size_t requested_size = size;
+    size += GUARD_LENGTH;
+#endif
+    size = roundUp(size);
+
+    if (stats_enabled) {
+      counters.allocate_calls++;
+      counters.size_histogram[AllocationStats::histogramBucket(size)]++;
+      counters.bytes_in_use += size;
+      counters.peak_bytes_in_use =
+          std::max(counters.peak_bytes_in_use, counters.bytes_in_use);
+    }
+
+    alignment = std::max(alignment, BLOCK_ALIGNMENT);
+
+    void *allocated_block = reserve(size, alignment);
+#ifdef CHUNK_ALLOCATOR_CHECKED
+    armBlock(allocated_block, requested_size);
+#endif
+    return allocated_block;
+  }
+
+  void deallocate_object(void *p, std::size_t size,
+                         std::size_t alignment = BLOCK_ALIGNMENT) {
+    if ((!p) || (size == 0)) {
+      return;
+    }
+#ifdef CHUNK_ALLOCATOR_CHECKED
+    disarmBlock(p, size);
+    size += GUARD_LENGTH;
+#endif
+    size = roundUp(size);
+
+    if (stats_enabled) {
+      counters.deallocate_calls++;
+      counters.bytes_in_use -= std::min(size, counters.bytes_in_use);
+    }
+
+    alignment = std::max(alignment, BLOCK_ALIGNMENT);
+
+    if (isLargeObject(size, alignment)) {
+      large_objects.erase(p);
+      upstream->deallocate(p, size, alignment);
+      return;
+    }
+
+    auto *deallocation_ptr = static_cast<std::uint8_t *>(p);
+    auto owner = chunks_by_address.upper_bound(deallocation_ptr);
+    if ((owner != chunks_by_address.begin()) &&
+        (--owner)->second->contains(deallocation_ptr)) {
+      Chunk *chunk = owner->second;
+      const std::size_t largest_free_block = chunk->largestFreeBlock();
+      chunk->releaseBlock(deallocation_ptr);
+      reindex(chunk, largest_free_block);
+    }
+  }
+
+  void setStatsEnabled(bool enabled) noexcept { stats_enabled = enabled; }
+
+  bool statsEnabled() const noexcept { return stats_enabled; }
+
+  void countConstruct() noexcept {
+    if (stats_enabled) {
+      counters.construct_calls++;
+    }
+  }
+
+  void countDestroy() noexcept {
+    if (stats_enabled) {
+      counters.destroy_calls++;
+    }
+  }
+
+  AllocationStats stats() const {
+    AllocationStats snapshot = counters;
+    snapshot.chunk_count = chunks_by_address.size();
+    snapshot.large_object_count = large_objects.size();
+
+    std::size_t free_bytes = 0;
+    std::size_t largest_free_block = 0;
+    for (const auto &chunk : chunks_by_address) {
+      free_bytes += chunk.second->freeBytes();
+    }
+    if (!chunks_by_space.empty()) {
+      largest_free_block = chunks_by_space.rbegin()->first;
+    }
+    if (free_bytes) {
+      snapshot.fragmentation =
+          1.0 - static_cast<double>(largest_free_block) / free_bytes;
+    }
+    return snapshot;
+  }
+
+private:
+  void *reserve(std::size_t size, std::size_t alignment) {
+    if (isLargeObject(size, alignment)) {
+      void *large_object = upstream->allocate(size, alignment);
+      large_objects.emplace(large_object, std::make_pair(size, alignment));
+      return large_object;
+    }
+
+    const std::size_t required = Chunk::requiredFreeBlock(size, alignment);
+    const auto fit = chunks_by_space.lower_bound({required, nullptr});
+    Chunk *chunk =
+        (fit != chunks_by_space.end()) ? fit->second : addChunk(required);
+
+    const std::size_t largest_free_block = chunk->largestFreeBlock();
+    std::uint8_t *allocated_block = chunk->reserveBlock(size, alignment);
+    assert(allocated_block);
+    reindex(chunk, largest_free_block);
+    return allocated_block;
+  }
+
+  Chunk *addChunk(std::size_t required) {
+    auto chunk = new Chunk(nextChunkSize(required), upstream);
+    chunks_by_address.emplace(chunk->data(), chunk);
+    chunks_by_space.emplace(chunk->largestFreeBlock(), chunk);
+    return chunk;
+  }
+
+  /* Moves chunk to its new place in chunks_by_space after a block was
+   * reserved or released in it. */
+  void reindex(Chunk *chunk, std::size_t old_largest_free_block) {
+    const std::size_t largest_free_block = chunk->largestFreeBlock();
+    if (largest_free_block != old_largest_free_block) {
+      auto entry = chunks_by_space.extract({old_largest_free_block, chunk});
+      entry.value().first = largest_free_block;
+      chunks_by_space.insert(std::move(entry));
+    }
+  }
+
+#ifdef CHUNK_ALLOCATOR_CHECKED
+  void armBlock(void *p, std::size_t requested_size) {
+    std::memset(static_cast<std::uint8_t *>(p) + requested_size, GUARD_BYTE,
+                GUARD_LENGTH);
+    live_blocks.emplace(p, requested_size);
+  }
+
+  void disarmBlock(void *p, std::size_t size) {
+    const auto live_block = live_blocks.find(p);
+    if (live_block == live_blocks.end()) {
+      reportHeapCorruption("double or invalid free", p);
+    }
+    if (live_block->second != size) {
+      reportHeapCorruption("deallocation size mismatch", p);
+    }
+
+    const auto *guard = static_cast<std::uint8_t *>(p) + size;
+    for (std::size_t i = 0; i < GUARD_LENGTH; ++i) {
+      if (guard[i] != GUARD_BYTE) {
+        reportHeapCorruption("buffer overflow", p);
+      }
+    }
+
+    std::memset(p, POISON_BYTE, size + GUARD_LENGTH);
+    live_blocks.erase(live_block);
+  }
+
+  void reportLeaks() const {
+    if (live_blocks.empty()) {
+      return;
+    }
+
+    std::size_t leaked_bytes = 0;
+    for (const auto &live_block : live_blocks) {
+      std::fprintf(stderr, "chunk allocator: leaked %zu bytes at %p\n",
+                   live_block.second, live_block.first);
+      leaked_bytes += live_block.second;
+    }
+    std::fprintf(stderr, "chunk allocator: %zu bytes leaked in %zu blocks\n",
+                 leaked_bytes, live_blocks.size());
+  }
+#endif
+
+  static bool isLargeObject(std::size_t size, std::size_t alignment) noexcept {
+    return (size > LARGE_OBJECT_THRESHOLD) || (alignment > MAX_BLOCK_ALIGNMENT);
+  }
+
+  static std::size_t roundUp(std::size_t size) noexcept {
+    return (size + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+  }
+
+  std::size_t nextChunkSize(std::size_t size) {
+    std::size_t chunk_size = next_chunk_size;
+    while (chunk_size < size + Chunk::HEADER_LENGTH) {
+      chunk_size *= 2;
+    }
+    next_chunk_size = std::min(chunk_size * 2, MAX_CHUNK_SIZE);
+    return chunk_size;
+  }
+};
+
+/* All copies of an allocator, rebound or not, share one AllocationMemory,
+ * released with the last of them. */
+template <typename T, std::size_t CHUNK_SIZE = 1024> class Allocator {
+  std::shared_ptr<AllocationMemory<CHUNK_SIZE>> memory;
+
+public:
+  using value_type = T;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using reference = T &;
+  using const_reference = const T &;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  template <typename U, std::size_t> friend class Allocator;
+
+  template <typename U> struct rebind {
+    using other = Allocator<U, CHUNK_SIZE>;
+  };
+
+public:
+  Allocator() : memory{std::make_shared<AllocationMemory<CHUNK_SIZE>>()} {}
+
+  Allocator(const Allocator &other) noexcept = default;
+
+  template <typename U>
+  Allocator(const Allocator<U, CHUNK_SIZE> &other) noexcept
+      : memory{other.memory} {}
+
+  T *allocate(std::size_t n) { return allocate(n, alignof(T)); }
+
+  /* alignment must be a power of two. */
+  T *allocate(std::size_t n, std::size_t alignment) {
+    return static_cast<T *>(memory->allocate_object(n * sizeof(T), alignment));
+  }
+
+  void deallocate(T *p, std::size_t n) { deallocate(p, n, alignof(T)); }
+
+  void deallocate(T *p, std::size_t n, std::size_t alignment) {
+    memory->deallocate_object(p, n * sizeof(T), alignment);
+  }
+
+  template <typename U, typename... Args>
+  void construct(U *ptr, Args &&... args) {
+    memory->countConstruct();
+    new (reinterpret_cast<void *>(ptr)) U{std::forward<Args>(args)...};
+  }
+
+  template <typename U> void destroy(U *ptr) {
+    memory->countDestroy();
+    ptr->~U();
+  }
+
+  /* The aligned operator new of the pool: builds a U aligned to alignof(U),
+   * over-aligned or not, and frees the memory again if the constructor
+   * throws. A placement operator new could not do the latter, since
+   * placement delete is not told the size. Free it with delete_object. */
+  template <typename U, typename... Args> U *new_object(Args &&... args) {
+    auto *ptr =
+        static_cast<U *>(memory->allocate_object(sizeof(U), alignof(U)));
+    try {
+      construct(ptr, std::forward<Args>(args)...);
+    } catch (...) {
+      memory->deallocate_object(ptr, sizeof(U), alignof(U));
+      throw;
+    }
+    return ptr;
+  }
+
+  template <typename U> void delete_object(U *ptr) {
+    destroy(ptr);
+    memory->deallocate_object(ptr, sizeof(U), alignof(U));
+  }
+
+  Allocator &operator=(const Allocator &other) noexcept = default;
+
+  /* Statistics are shared by all copies of the allocator and are off by
+   * default, so the hot path only pays for a single branch. */
+  void enableStats(bool enabled = true) noexcept {
+    memory->setStatsEnabled(enabled);
+  }
+
+  AllocationStats stats() const { return memory->stats(); }
+
+  template <typename U>
+  bool operator==(const Allocator<U, CHUNK_SIZE> &other) const noexcept {
+    return memory == other.memory;
+  }
+
+  template <typename U>
+  bool operator!=(const Allocator<U, CHUNK_SIZE> &other) const noexcept {
+    return memory != other.memory;
+  }
+};
+
+/* Hands the pages of [p, p + size) that lie entirely inside the range back
+ * to the OS. The range stays mapped and reads back as zeroes. */
+inline void discardPages(void *p, std::size_t size) noexcept {
+  const auto page_size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+  const auto begin = (reinterpret_cast<std::uintptr_t>(p) + page_size - 1) &
+                     ~(page_size - 1);
+  const auto end = (reinterpret_cast<std::uintptr_t>(p) + size) &
+                   ~(page_size - 1);
+  if (begin < end) {
+    madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+  }
+}
+
+/* Upstream resource that maps every allocation straight from the OS with
+ * mmap, bypassing the heap. With huge pages enabled, mappings are rounded
+ * and aligned to HUGE_PAGE_SIZE and advised MADV_HUGEPAGE so that large
+ * chunks are backed by transparent huge pages. Use it as the upstream of
+ * MonotonicArena or PoolResource with a CHUNK_SIZE of the same order. */
+class MappedResource : public std::pmr::memory_resource {
+public:
+  static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+private:
+  const bool huge_pages;
+  const std::size_t granularity;
+
+public:
+  explicit MappedResource(bool huge_pages = false)
+      : huge_pages{huge_pages},
+        granularity{huge_pages
+                        ? HUGE_PAGE_SIZE
+                        : static_cast<std::size_t>(sysconf(_SC_PAGESIZE))} {}
+
+  bool hugePages() const noexcept { return huge_pages; }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (alignment > granularity) {
+      throw std::bad_alloc();
+    }
+
+    const std::size_t length = mappingLength(bytes);
+    const std::size_t slack = huge_pages ? granularity : 0;
+
+    void *mapping = mmap(nullptr, length + slack, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    if (!huge_pages) {
+      return mapping;
+    }
+
+    /* Trim the mapping so it starts on a huge page boundary. */
+    auto *begin = static_cast<std::uint8_t *>(mapping);
+    auto *aligned = reinterpret_cast<std::uint8_t *>(
+        (reinterpret_cast<std::uintptr_t>(begin) + granularity - 1) &
+        ~(static_cast<std::uintptr_t>(granularity) - 1));
+    if (aligned != begin) {
+      munmap(begin, aligned - begin);
+    }
+    if (aligned + length != begin + length + slack) {
+      munmap(aligned + length, begin + slack - aligned);
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+    return aligned;
+  }
+
+  void do_deallocate(void *p, std::size_t bytes, std::size_t) override {
+    munmap(p, mappingLength(bytes));
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override {
+    return this == &other;
+  }
+
+private:
+  std::size_t mappingLength(std::size_t bytes) const noexcept {
+    return (bytes + granularity - 1) / granularity * granularity;
+  }
+};
+
+/* Bump-pointer arena over Chunk storage. Deallocation is a no-op: memory is
+ * reclaimed all at once by reset(), which keeps the chunks for reuse, or by
+ * release(), which frees them. */
+template <std::size_t CHUNK_SIZE = 1024>
+class MonotonicArena : public std::pmr::memory_resource {
+  static constexpr std::size_t MAX_CHUNK_SIZE = CHUNK_SIZE * 64;
+
+  std::pmr::memory_resource *upstream;
+  std::vector<Chunk *> chunks;
+  std::size_t current_chunk = 0;
+  std::size_t offset = 0;
+  std::size_t next_chunk_size = CHUNK_SIZE;
+
+public:
+  explicit MonotonicArena(
+      std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : upstream{upstream} {}
+
+  MonotonicArena(const MonotonicArena &) = delete;
+  MonotonicArena &operator=(const MonotonicArena &) = delete;
+
+  ~MonotonicArena() override { release(); }
+
+  void *allocate_bytes(std::size_t size,
+                       std::size_t alignment = alignof(std::max_align_t)) {
+    if (size == 0) {
+      size = 1;
+    }
+
+    while (current_chunk < chunks.size()) {
+      void *block = bump(chunks[current_chunk], size, alignment);
+      if (block) {
+        return block;
+      }
+      current_chunk++;
+      offset = 0;
+    }
+
+    auto chunk = new Chunk(nextChunkSize(size + alignment), upstream);
+    chunks.push_back(chunk);
+    current_chunk = chunks.size() - 1;
+    offset = 0;
+
+    void *block = bump(chunk, size, alignment);
+    assert(block);
+    return block;
+  }
+
+  /* With discard_pages set, the pages of every chunk are also returned to
+   * the OS; the chunks stay mapped and fault back in on reuse. */
+  void reset(bool discard_pages = false) noexcept {
+    if (discard_pages) {
+      for (auto &chunk : chunks) {
+        discardPages(chunk->data(), chunk->size());
+      }
+    }
+    current_chunk = 0;
+    offset = 0;
+  }
+
+  void release() noexcept {
+    for (auto &chunk : chunks) {
+      delete chunk;
+    }
+    chunks.clear();
+    next_chunk_size = CHUNK_SIZE;
+    reset();
+  }
+
+  std::size_t chunkCount() const noexcept { return chunks.size(); }
+
+  std::pmr::memory_resource *upstream_resource() const noexcept {
+    return upstream;
+  }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    return allocate_bytes(bytes, alignment);
+  }
+
+  void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override {
+    return this == &other;
+  }
+
+private:
+  void *bump(Chunk *chunk, std::size_t size, std::size_t alignment) noexcept {
+    void *block = chunk->data() + offset;
+    std::size_t space = chunk->size() - offset;
+    if (!std::align(alignment, size, block, space)) {
+      return nullptr;
+    }
+    offset = chunk->size() - space + size;
+    return block;
+  }
+
+  std::size_t nextChunkSize(std::size_t size) {
+    std::size_t chunk_size = next_chunk_size;
+    while (chunk_size < size) {
+      chunk_size *= 2;
+    }
+    next_chunk_size = std::min(chunk_size * 2, MAX_CHUNK_SIZE);
+    return chunk_size;
+  }
+};
+
+/* std::pmr adapter for the chunk pool. */
+template <std::size_t CHUNK_SIZE = 1024>
+class PoolResource : public std::pmr::memory_resource {
+  AllocationMemory<CHUNK_SIZE> memory;
+
+public:
+  explicit PoolResource(
+      std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : memory{upstream} {}
+
+  std::pmr::memory_resource *upstream_resource() const noexcept {
+    return memory.upstream_resource();
+  }
+
+  void enableStats(bool enabled = true) noexcept {
+    memory.setStatsEnabled(enabled);
+  }
+
+  AllocationStats stats() const { return memory.stats(); }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    return memory.allocate_object(std::max<std::size_t>(bytes, 1), alignment);
+  }
+
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    memory.deallocate_object(p, std::max<std::size_t>(bytes, 1), alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override {
+    return this == &other;
+  }
+};
@@ -0,0 +1,290 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "allocator.h"
+
+/* Replays allocation traces against the chunk Allocator, std::allocator
+ * (the system malloc), std::pmr::unsynchronized_pool_resource and the chunk
+ * pool over huge-page mappings, and reports ns per trace operation, resident
+ * set growth and, where the engine can report it, fragmentation.
+ *
+ * Usage: ./allocator_bench [scale] */
+
+namespace {
+
+std::size_t ResidentBytes() {
+  long pages_total = 0;
+  long pages_resident = 0;
+  if (FILE *statm = std::fopen("/proc/self/statm", "r")) {
+    if (std::fscanf(statm, "%ld %ld", &pages_total, &pages_resident) != 2) {
+      pages_resident = 0;
+    }
+    std::fclose(statm);
+  }
+  return static_cast<std::size_t>(pages_resident) * sysconf(_SC_PAGESIZE);
+}
+
+/* Keeps the highest RSS seen at the sample points of a trace. */
+class Probe {
+  std::size_t baseline = ResidentBytes();
+  std::size_t peak = baseline;
+
+public:
+  void sample() { peak = std::max(peak, ResidentBytes()); }
+
+  std::size_t growth() const { return peak - baseline; }
+};
+
+struct ChunkEngine {
+  static constexpr const char *name = "chunk";
+  static constexpr bool thread_safe = false;
+
+  template <typename T> using allocator = Allocator<T>;
+
+  Allocator<char> memory;
+
+  template <typename T> allocator<T> get() { return allocator<T>(memory); }
+
+  double fragmentation() const { return memory.stats().fragmentation; }
+};
+
+struct StdEngine {
+  static constexpr const char *name = "std";
+  static constexpr bool thread_safe = true;
+
+  template <typename T> using allocator = std::allocator<T>;
+
+  template <typename T> allocator<T> get() { return {}; }
+
+  double fragmentation() const { return -1.0; }
+};
+
+struct PmrPoolEngine {
+  static constexpr const char *name = "pmr_pool";
+  static constexpr bool thread_safe = false;
+
+  template <typename T> using allocator = std::pmr::polymorphic_allocator<T>;
+
+  std::pmr::unsynchronized_pool_resource resource;
+
+  template <typename T> allocator<T> get() { return &resource; }
+
+  double fragmentation() const { return -1.0; }
+};
+
+/* The chunk pool with its chunks mapped from huge pages. Chunks start at
+ * one huge page, so each mapping is used in full. */
+struct MappedPoolEngine {
+  static constexpr const char *name = "pool_mmap";
+  static constexpr bool thread_safe = false;
+
+  template <typename T> using allocator = std::pmr::polymorphic_allocator<T>;
+
+  MappedResource pages{true};
+  PoolResource<MappedResource::HUGE_PAGE_SIZE> resource{&pages};
+
+  template <typename T> allocator<T> get() { return &resource; }
+
+  double fragmentation() const { return resource.stats().fragmentation; }
+};
+
+/* Every trace returns the number of operations it performed. */
+
+template <typename Engine>
+std::size_t VectorGrowth(Engine &engine, Probe &probe, std::size_t scale) {
+  const std::size_t rounds = 20 * scale;
+  const std::size_t elements = 100'000;
+
+  for (std::size_t round = 0; round < rounds; ++round) {
+    std::vector<int, typename Engine::template allocator<int>> vector{
+        engine.template get<int>()};
+    for (std::size_t i = 0; i < elements; ++i) {
+      vector.push_back(static_cast<int>(i));
+    }
+    probe.sample();
+  }
+  return rounds * elements;
+}
+
+template <typename Engine>
+std::size_t MapChurn(Engine &engine, Probe &probe, std::size_t scale) {
+  using value_type = std::pair<const int, int>;
+  using map_type =
+      std::map<int, int, std::less<>,
+               typename Engine::template allocator<value_type>>;
+
+  const std::size_t live_keys = 20'000;
+  const std::size_t churn = 200'000 * scale;
+
+  std::mt19937 random{42};
+  std::uniform_int_distribution<int> key{0, 4 * static_cast<int>(live_keys)};
+
+  map_type map{engine.template get<value_type>()};
+  while (map.size() < live_keys) {
+    map.emplace(key(random), 0);
+  }
+  for (std::size_t i = 0; i < churn; ++i) {
+    auto victim = map.lower_bound(key(random));
+    map.erase(victim == map.end() ? map.begin() : victim);
+    map.emplace(key(random), static_cast<int>(i));
+  }
+  probe.sample();
+  return live_keys + 2 * churn;
+}
+
+template <typename Engine>
+std::size_t StringConcatenation(Engine &engine, Probe &probe,
+                                std::size_t scale) {
+  using string_type =
+      std::basic_string<char, std::char_traits<char>,
+                        typename Engine::template allocator<char>>;
+
+  const std::size_t strings = 20'000 * scale;
+  const std::size_t pieces = 16;
+
+  std::mt19937 random{7};
+  std::uniform_int_distribution<std::size_t> length{1, 48};
+
+  std::vector<string_type> results;
+  results.reserve(strings);
+  for (std::size_t i = 0; i < strings; ++i) {
+    string_type result{engine.template get<char>()};
+    for (std::size_t piece = 0; piece < pieces; ++piece) {
+      result = result + string_type(length(random), 'x',
+                                    engine.template get<char>());
+    }
+    results.push_back(std::move(result));
+  }
+  probe.sample();
+  return strings * pieces;
+}
+
+/* One thread allocates buffers, another frees them. Engines that are not
+ * thread-safe are serialised through a mutex around every call. */
+template <typename Engine>
+std::size_t ProducerConsumer(Engine &engine, Probe &probe, std::size_t scale) {
+  using allocator_type = typename Engine::template allocator<std::uint64_t>;
+  using traits = std::allocator_traits<allocator_type>;
+
+  const std::size_t messages = 200'000 * scale;
+
+  allocator_type allocator = engine.template get<std::uint64_t>();
+  std::mutex allocator_mutex;
+  auto guarded = [&allocator_mutex](auto &&call) {
+    if (Engine::thread_safe) {
+      return call();
+    }
+    std::lock_guard<std::mutex> lock{allocator_mutex};
+    return call();
+  };
+
+  std::mutex queue_mutex;
+  std::condition_variable queue_ready;
+  std::deque<std::pair<std::uint64_t *, std::size_t>> queue;
+  bool done = false;
+
+  std::thread consumer{[&] {
+    for (;;) {
+      std::unique_lock<std::mutex> lock{queue_mutex};
+      queue_ready.wait(lock, [&] { return done || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      auto message = queue.front();
+      queue.pop_front();
+      lock.unlock();
+
+      guarded([&] {
+        traits::deallocate(allocator, message.first, message.second);
+        return 0;
+      });
+    }
+  }};
+
+  std::mt19937 random{13};
+  std::uniform_int_distribution<std::size_t> length{1, 64};
+  for (std::size_t i = 0; i < messages; ++i) {
+    const std::size_t n = length(random);
+    std::uint64_t *buffer =
+        guarded([&] { return traits::allocate(allocator, n); });
+    buffer[0] = i;
+    {
+      std::lock_guard<std::mutex> lock{queue_mutex};
+      queue.emplace_back(buffer, n);
+    }
+    queue_ready.notify_one();
+    if (i % 1024 == 0) {
+      probe.sample();
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock{queue_mutex};
+    done = true;
+  }
+  queue_ready.notify_one();
+  consumer.join();
+  return 2 * messages;
+}
+
+template <typename Engine>
+void Run(const char *trace_name,
+         std::size_t (*trace)(Engine &, Probe &, std::size_t),
+         std::size_t scale) {
+  auto engine = std::make_unique<Engine>();
+  Probe probe;
+
+  const auto start = std::chrono::steady_clock::now();
+  const std::size_t operations = trace(*engine, probe, scale);
+  const auto finish = std::chrono::steady_clock::now();
+
+  const double ns_per_op =
+      std::chrono::duration<double, std::nano>(finish - start).count() /
+      operations;
+  const double fragmentation = engine->fragmentation();
+
+  std::printf("%-20s %-10s %10.2f %12zu", trace_name, Engine::name, ns_per_op,
+              probe.growth() / 1024);
+  if (fragmentation >= 0.0) {
+    std::printf(" %14.3f\n", fragmentation);
+  } else {
+    std::printf(" %14s\n", "-");
+  }
+}
+
+template <typename Engine> void RunAll(std::size_t scale) {
+  Run<Engine>("vector_growth", VectorGrowth<Engine>, scale);
+  Run<Engine>("map_churn", MapChurn<Engine>, scale);
+  Run<Engine>("string_concat", StringConcatenation<Engine>, scale);
+  Run<Engine>("producer_consumer", ProducerConsumer<Engine>, scale);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t scale =
+      (argc > 1) ? std::max(1l, std::strtol(argv[1], nullptr, 10)) : 1;
+
+  std::printf("%-20s %-10s %10s %12s %14s\n", "trace", "engine", "ns/op",
+              "rss_kib", "fragmentation");
+
+  RunAll<StdEngine>(scale);
+  RunAll<PmrPoolEngine>(scale);
+  RunAll<ChunkEngine>(scale);
+  RunAll<MappedPoolEngine>(scale);
+
+  return 0;
+}
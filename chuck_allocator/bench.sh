@@ -0,0 +1,6 @@
+#!/bin/bash
+
+set -e
+
+g++ -std=c++17 -O2 -pthread -I./ bench.cpp -o allocator_bench
+./allocator_bench "$@"
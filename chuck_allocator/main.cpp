@@ -1,246 +1,20 @@
-#include <algorithm>
-#include <array>
 #include <cassert>
-#include <deque>
 #include <iostream>
 #include <list>
 #include <map>
+#include <memory_resource>
 #include <set>
-#include <utility>
+#include <string>
 #include <vector>
 
-template <std::size_t CHUNK_SIZE> class Chunk {
-
-  static const std::size_t HEADER_LENGTH = 4;
-
-  std::uint32_t *point_end_block;
-  std::set<std::uint32_t *> free_blocks;
-  std::vector<std::uint8_t *> blocks;
-
-public:
-  Chunk() {
-    blocks.resize(CHUNK_SIZE);
-
-    auto *pointer_header = reinterpret_cast<std::uint32_t *>(blocks.data());
-
-    *pointer_header = CHUNK_SIZE - HEADER_LENGTH;
-    point_end_block = pointer_header;
-    free_blocks.insert(pointer_header);
-  }
-
-  ~Chunk() = default;
-
-  bool contains(const std::uint8_t *address) const noexcept {
-    const auto *start_chunk =
-        reinterpret_cast<const std::uint8_t *>(blocks.data());
-    const auto *end_chunk = start_chunk + CHUNK_SIZE;
-    return (start_chunk <= address) && (address <= end_chunk);
-  }
-
-  std::uint8_t *reserveBlock(std::size_t allocation_size) {
-    const auto alloc_size_req = static_cast<std::uint32_t>(allocation_size);
-
-    if ((!point_end_block) || (alloc_size_req > *point_end_block)) {
-      return nullptr;
-    }
-
-    auto comp_min_block = [alloc_size_req](const std::uint32_t *lhs,
-                                           const std::uint32_t *rhs) {
-      if (*rhs < alloc_size_req)
-        return true;
-
-      return (*lhs < *rhs) && (*lhs >= alloc_size_req);
-    };
-
-    const auto min_item = std::min_element(free_blocks.cbegin(),
-                                           free_blocks.cend(), comp_min_block);
-
-    std::uint32_t *header_address = *min_item;
-    auto *new_header_address = reinterpret_cast<std::uint32_t *>(
-        reinterpret_cast<std::uint8_t *>(header_address) + HEADER_LENGTH +
-            alloc_size_req);
-
-    if (free_blocks.find(new_header_address) == free_blocks.cend()) {
-      const std::uint32_t old_block_size = *header_address;
-      const std::uint32_t difference = old_block_size - HEADER_LENGTH;
-
-      if (difference >= alloc_size_req) {
-        const std::uint32_t new_block_size = difference - alloc_size_req;
-        *new_header_address = new_block_size;
-        free_blocks.insert(new_header_address);
-      }
-    }
-
-    free_blocks.erase(header_address);
-
-    *header_address = static_cast<std::uint32_t>(allocation_size);
-
-    if (header_address == point_end_block) {
-
-      auto comp_max_block = [](const std::uint32_t *lhs,
-                               const std::uint32_t *rhs) {
-        return (*lhs) < (*rhs);
-      };
-
-      const auto max_it = std::max_element(free_blocks.cbegin(),
-                                           free_blocks.cend(), comp_max_block);
-
-      point_end_block = (max_it != free_blocks.cend()) ? (*max_it) : (nullptr);
-    }
-
-    return reinterpret_cast<std::uint8_t *>(header_address) + HEADER_LENGTH;
-  }
-
-  void releaseBlock(std::uint8_t *block_ptr) {
-    std::uint8_t *header_address = block_ptr - HEADER_LENGTH;
-    const std::uint32_t size_relized_block = *header_address;
-
-    if ((!point_end_block) || (size_relized_block > *point_end_block)) {
-      point_end_block = reinterpret_cast<std::uint32_t *>(header_address);
-    }
-
-    free_blocks.insert(reinterpret_cast<std::uint32_t *>(header_address));
-  }
-};
-
-template <std::size_t CHUNK_SIZE> class AllocationMemory {
-  std::list<Chunk<CHUNK_SIZE> *> chunks;
-
-public:
-  AllocationMemory() = default;
-
-  ~AllocationMemory() {
-    for (auto &chunk : chunks) {
-      delete chunk;
-    }
-  }
-
-  void *allocate_object(std::size_t size) {
-
-    if (size == 0) {
-      return nullptr;
-    }
-
-    for (auto &chunk : chunks) {
-      void *allocated_block = chunk->reserveBlock(size);
-      if (allocated_block) {
-        return allocated_block;
-      }
-    }
-
-    auto chunk = new Chunk<CHUNK_SIZE>();
-
-    chunks.push_back(chunk);
-    std::uint8_t *allocated_block = chunk->reserveBlock(size);
-    return allocated_block;
-  }
-
-  void deallocate_object(void *p, std::size_t size) {
-    if ((!p) || (size == 0)) {
-      return;
-    }
-
-    auto *deallocation_ptr = static_cast<std::uint8_t *>(p);
-    for (auto &chunk : chunks) {
-      if (chunk->contains(deallocation_ptr)) {
-        chunk->releaseBlock(deallocation_ptr);
-      }
-    }
-  }
-};
-
-template <typename T, std::size_t CHUNK_SIZE = 1024> class Allocator {
-  AllocationMemory<CHUNK_SIZE> *memory;
-  size_t *number_instances;
-
-public:
-  using value_type = T;
-  using pointer = T *;
-  using const_pointer = const T *;
-  using reference = T &;
-  using const_reference = const T &;
-  using size_type = std::size_t;
-  using difference_type = std::ptrdiff_t;
-
-  template <typename U, std::size_t> friend class Allocator;
-
-  template <typename U> struct rebind { using other = Allocator<U>; };
-
-public:
-  Allocator() {
-    memory = new AllocationMemory<CHUNK_SIZE>();
-    number_instances = new size_t(1);
-
-    std::cout << std::endl
-              << "---Crete allocator and allocate memory---"
-              << (*number_instances) << std::endl;
-  };
-
-  Allocator(const Allocator &other) noexcept {
-    memory = other.memory;
-    number_instances = other.number_instances;
-    (*number_instances)++;
-  }
-
-  ~Allocator() {
-    if ((*number_instances) > 1) {
-
-      (*number_instances)--;
-
-      std::cout << std::endl
-                << "---Call destructor for copped allocator---" << std::endl
-                << " Number remains instances : " << (*number_instances)
-                << std::endl;
-    } else {
-      delete memory;
-
-      std::cout << std::endl
-                << "---Destroy allocator and release memory---" << std::endl;
-    }
-  }
-
-  template <typename U> Allocator(const Allocator<U> &other) noexcept {
-    memory = other.memory;
-    number_instances = other.number_instances;
-    (*number_instances)++;
-  }
-
-  T *allocate(std::size_t n) {
-    return static_cast<T *>(memory->allocate_object(n * sizeof(T)));
-  }
-
-  void deallocate(T *p, std::size_t n) {}
-
-  template <typename U, typename... Args>
-  void construct(U *ptr, Args &&... args) {
-    new (reinterpret_cast<void *>(ptr)) U{std::forward<Args>(args)...};
-  }
-
-  template <typename U> void destroy(U *ptr) { ptr->~U(); }
-
-  Allocator &operator=(const Allocator &a) {
-    if (this == &a)
-      return *this;
-
-    if ((*number_instances) > 1) {
-      delete memory;
-    } else {
-      (*number_instances)--;
-    }
-
-    memory = a.memory;
-    number_instances = a.number_instances;
-    (*number_instances)++;
-
-    return *this;
-  }
-};
+#include "allocator.h"
 
 int main(int argc, char **argv) {
 
   {
     /* Test copy allocator*/
     Allocator<int> custom_int_allocator;
+    custom_int_allocator.enableStats();
 
     Allocator<float> custom_float_allocator{custom_int_allocator};
 
@@ -254,11 +28,26 @@ int main(int argc, char **argv) {
 
     std::cout << std::endl;
 
+    for (int i = 50; i < 10000; ++i) {
+      vector.push_back(i);
+    }
+    assert(vector.back() == 9999);
+
     vector.resize(16);
     for (int val : vector) {
       std::cout << val << " ";
     }
 
+    const AllocationStats stats = custom_int_allocator.stats();
+    std::cout << std::endl
+              << "in use: " << stats.bytes_in_use
+              << " peak: " << stats.peak_bytes_in_use
+              << " chunks: " << stats.chunk_count
+              << " large objects: " << stats.large_object_count
+              << " fragmentation: " << stats.fragmentation
+              << " allocate calls: " << stats.allocate_calls
+              << " deallocate calls: " << stats.deallocate_calls << std::endl;
+
     /* Test allocator for list<float> stl container*/
 
     std::list<float, Allocator<float>> list{
@@ -310,7 +99,121 @@ int main(int argc, char **argv) {
 
       std::cout << result_string;
     }
+
+    /* Test allocator for over-aligned types*/
+    struct alignas(64) CacheLine {
+      double values[8];
+    };
+
+    Allocator<CacheLine> allocator_for_cache_lines;
+    std::vector<CacheLine, Allocator<CacheLine>> cache_lines{
+        allocator_for_cache_lines};
+    for (int i = 0; i < 100; ++i) {
+      cache_lines.push_back(CacheLine{{static_cast<double>(i)}});
+      assert(reinterpret_cast<std::uintptr_t>(cache_lines.data()) % 64 == 0);
+    }
+
+    struct alignas(256) Page {
+      char bytes[256];
+    };
+
+    CacheLine *line = allocator_for_cache_lines.new_object<CacheLine>();
+    Page *page = allocator_for_cache_lines.new_object<Page>();
+    assert(reinterpret_cast<std::uintptr_t>(line) % alignof(CacheLine) == 0);
+    assert(reinterpret_cast<std::uintptr_t>(page) % alignof(Page) == 0);
+    allocator_for_cache_lines.delete_object(page);
+    allocator_for_cache_lines.delete_object(line);
+
+    Allocator<char> allocator_for_bytes;
+    for (std::size_t alignment = 1; alignment <= 128; alignment *= 2) {
+      char *bytes = allocator_for_bytes.allocate(24, alignment);
+      assert(reinterpret_cast<std::uintptr_t>(bytes) % alignment == 0);
+      allocator_for_bytes.deallocate(bytes, 24, alignment);
+    }
+
+    /* Test that freed neighbours merge back into one free block*/
+    {
+      Allocator<char, 65536> allocator_for_blocks;
+      allocator_for_blocks.enableStats();
+      std::vector<std::pair<char *, std::size_t>> blocks;
+      for (std::size_t i = 0; i < 200; ++i) {
+        const std::size_t size = 1 + (i * 37) % 300;
+        blocks.emplace_back(allocator_for_blocks.allocate(size), size);
+      }
+      for (std::size_t i = 0; i < blocks.size(); ++i) {
+        auto &block = blocks[(i * 61) % blocks.size()];
+        allocator_for_blocks.deallocate(block.first, block.second);
+      }
+      const AllocationStats released = allocator_for_blocks.stats();
+      assert(released.chunk_count == 1);
+      assert(released.bytes_in_use == 0);
+      assert(released.fragmentation == 0.0);
+    }
+
+    /* Test that chunks emptied by deallocation are found again*/
+    {
+      Allocator<char> allocator_for_chunks;
+      allocator_for_chunks.enableStats();
+      std::vector<char *> blocks;
+      for (std::size_t i = 0; i < 2000; ++i) {
+        blocks.push_back(allocator_for_chunks.allocate(512));
+      }
+      const std::size_t chunk_count = allocator_for_chunks.stats().chunk_count;
+      assert(chunk_count > 1);
+      for (int round = 0; round < 2; ++round) {
+        for (auto *block : blocks) {
+          allocator_for_chunks.deallocate(block, 512);
+        }
+        for (auto &block : blocks) {
+          block = allocator_for_chunks.allocate(512);
+        }
+      }
+      assert(allocator_for_chunks.stats().chunk_count == chunk_count);
+      for (auto *block : blocks) {
+        allocator_for_chunks.deallocate(block, 512);
+      }
+    }
+
+    /* Test monotonic arena as a memory resource*/
+    MonotonicArena<> arena;
+    for (int round = 0; round < 3; ++round) {
+      std::pmr::vector<double> doubles{&arena};
+      for (int i = 0; i < 1000; ++i) {
+        doubles.push_back(i);
+      }
+      assert(doubles.back() == 999.0);
+      assert(reinterpret_cast<std::uintptr_t>(doubles.data()) %
+                 alignof(double) ==
+             0);
+      arena.reset();
+    }
+    std::cout << "arena chunks: " << arena.chunkCount() << std::endl;
+
+    /* Test arena over huge-page mappings*/
+    MappedResource huge_pages{true};
+    MonotonicArena<MappedResource::HUGE_PAGE_SIZE> mapped_arena{&huge_pages};
+    for (int round = 0; round < 2; ++round) {
+      std::pmr::vector<int> ints{&mapped_arena};
+      ints.resize(1 << 20, round);
+      assert(ints.back() == round);
+      mapped_arena.reset(true);
+    }
+
+    /* Test pmr containers sharing one pool nested over an arena*/
+    MonotonicArena<> upstream_arena;
+    PoolResource<> pool{&upstream_arena};
+    {
+      std::pmr::vector<int> ints{&pool};
+      std::pmr::map<int, int> squares{&pool};
+      for (int i = 0; i < 100; ++i) {
+        ints.push_back(i);
+        squares.emplace(i, i * i);
+      }
+      assert(ints.size() == squares.size());
+      assert(squares.at(9) == 81);
+    }
+    std::cout << "pool chunks: " << pool.stats().chunk_count << std::endl;
   }
 
   return 0;
-}
\ No newline at end of file
+}
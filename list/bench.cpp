@@ -0,0 +1,196 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "src/concurrent_queue.h"
+#include "src/list.h"
+#include "src/unrolled_list.h"
+
+// Times building, iterating and inserting into the middle of
+// task::unrolled_list, task::list and std::list of ints, and reports ns per
+// element or per insert. Then has 1 to 64 threads each push and pop in
+// pairs on task::concurrent_queue and on a task::list behind a mutex, and
+// reports the total throughput.
+//
+// Usage: ./list_bench [elements]
+
+namespace {
+
+template <class List> struct Engine;
+
+template <> struct Engine<std::list<int>> {
+  static constexpr const char *name = "std::list";
+};
+
+template <> struct Engine<task::list<int>> {
+  static constexpr const char *name = "task::list";
+};
+
+template <> struct Engine<task::unrolled_list<int>> {
+  static constexpr const char *name = "unrolled";
+};
+
+template <>
+struct Engine<
+    task::unrolled_list<int, std::allocator<int>, task::unrolled_policy::stable>> {
+  static constexpr const char *name = "unrolled_stable";
+};
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void Report(const char *trace, const char *engine, double seconds,
+            size_t operations) {
+  std::printf("%-16s %-16s %10.2f\n", trace, engine,
+              seconds * 1e9 / operations);
+}
+
+// Keeps the optimiser from discarding the traversals.
+volatile long sink;
+
+template <class List> void RunAll(size_t elements) {
+  const char *name = Engine<List>::name;
+  List list;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < elements; ++i) {
+    list.push_back(static_cast<int>(i));
+  }
+  Report("push_back", name, Seconds(start), elements);
+
+  const size_t passes = 10;
+  start = std::chrono::steady_clock::now();
+  for (size_t pass = 0; pass < passes; ++pass) {
+    long sum = 0;
+    for (int value : list) {
+      sum += value;
+    }
+    sink = sum;
+  }
+  Report("iterate", name, Seconds(start), passes * elements);
+
+  // Walk forward a few elements at a time, inserting as we go, and wrap
+  // around at the end.
+  const size_t inserts = elements / 10;
+  std::mt19937 random{42};
+  std::uniform_int_distribution<int> step{0, 15};
+  auto it = list.begin();
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < inserts; ++i) {
+    for (int s = step(random); s > 0 && it != list.end(); --s) {
+      ++it;
+    }
+    if (it == list.end()) {
+      it = list.begin();
+    }
+    it = std::next(list.insert(it, static_cast<int>(i)));
+  }
+  Report("insert_middle", name, Seconds(start), inserts);
+
+  start = std::chrono::steady_clock::now();
+  long sum = 0;
+  for (int value : list) {
+    sum += value;
+  }
+  sink = sum;
+  Report("iterate_after", name, Seconds(start), list.size());
+
+  start = std::chrono::steady_clock::now();
+  const size_t erased = list.size();
+  while (!list.empty()) {
+    list.pop_front();
+  }
+  Report("pop_front", name, Seconds(start), erased);
+}
+
+struct LockedList {
+  static constexpr const char *name = "mutex+list";
+
+  std::mutex mutex;
+  task::list<int> list;
+
+  void push_back(int value) {
+    std::lock_guard<std::mutex> lock{mutex};
+    list.push_back(value);
+  }
+
+  bool try_pop(int &value) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (list.empty()) {
+      return false;
+    }
+    value = list.front();
+    list.pop_front();
+    return true;
+  }
+};
+
+struct LockFreeQueue {
+  static constexpr const char *name = "concurrent";
+
+  task::concurrent_queue<int> queue;
+
+  void push_back(int value) { queue.push_back(value); }
+
+  bool try_pop(int &value) { return queue.try_pop(value); }
+};
+
+template <class Queue> void RunQueue(size_t threads, size_t pairs) {
+  Queue queue;
+  std::vector<std::thread> workers;
+  const size_t per_thread = pairs / threads;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&queue, per_thread] {
+      int value = 0;
+      long sum = 0;
+      for (size_t i = 0; i < per_thread; ++i) {
+        queue.push_back(static_cast<int>(i));
+        if (queue.try_pop(value)) {
+          sum += value;
+        }
+      }
+      sink = sum;
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  const double seconds = Seconds(start);
+
+  std::printf("%-16s %-16s %7zu %10.2f\n", "push_pop", Queue::name, threads,
+              2 * threads * per_thread / seconds / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const size_t elements =
+      (argc > 1) ? std::max(1l, std::strtol(argv[1], nullptr, 10)) : 10'000'000;
+
+  std::printf("%-16s %-16s %10s\n", "trace", "list", "ns/op");
+
+  RunAll<std::list<int>>(elements);
+  RunAll<task::list<int>>(elements);
+  RunAll<task::unrolled_list<int>>(elements);
+  RunAll<task::unrolled_list<int, std::allocator<int>,
+                             task::unrolled_policy::stable>>(elements);
+
+  std::printf("\n%-16s %-16s %7s %10s\n", "trace", "queue", "threads",
+              "Mops/s");
+  const size_t pairs = std::max<size_t>(elements / 5, 64);
+  for (size_t threads = 1; threads <= 64; threads *= 2) {
+    RunQueue<LockedList>(threads, pairs);
+    RunQueue<LockFreeQueue>(threads, pairs);
+  }
+
+  return 0;
+}
@@ -0,0 +1,291 @@
+#include "concurrent_queue.h"
+
+#include <optional>
+#include <thread>
+
+namespace task {
+
+template <class T, class Alloc> size_t concurrent_queue<T, Alloc>::next_id() {
+  static std::atomic<size_t> last_id{0};
+  return last_id.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+template <class T, class Alloc>
+T *concurrent_queue<T, Alloc>::value(Node *node) {
+  return reinterpret_cast<T *>(&node->_value);
+}
+
+template <class T, class Alloc>
+typename concurrent_queue<T, Alloc>::Node *
+concurrent_queue<T, Alloc>::allocate_node() {
+  Node *node = node_traits::allocate(_allocator, 1);
+  node->_next.store(nullptr, std::memory_order_relaxed);
+  return node;
+}
+
+template <class T, class Alloc>
+void concurrent_queue<T, Alloc>::deallocate_node(Node *node) {
+  node_traits::deallocate(_allocator, node, 1);
+}
+
+template <class T, class Alloc>
+concurrent_queue<T, Alloc>::concurrent_queue()
+    : concurrent_queue(Alloc()) {}
+
+template <class T, class Alloc>
+concurrent_queue<T, Alloc>::concurrent_queue(const Alloc &alloc)
+    : _allocator(alloc), _records{nullptr}, _record_count{0},
+      _id(next_id()) {
+  Node *dummy = allocate_node();
+  _head.store(dummy, std::memory_order_relaxed);
+  _tail.store(dummy, std::memory_order_relaxed);
+}
+
+// No other thread may use the queue any more.
+template <class T, class Alloc> concurrent_queue<T, Alloc>::~concurrent_queue() {
+  Node *node = _head.load(std::memory_order_relaxed);
+  Node *next = node->_next.load(std::memory_order_relaxed);
+  deallocate_node(node);
+  for (node = next; node; node = next) {
+    next = node->_next.load(std::memory_order_relaxed);
+    node_traits::destroy(_allocator, value(node));
+    deallocate_node(node);
+  }
+
+  Record *record = _records.load(std::memory_order_relaxed);
+  while (record) {
+    Record *next_record = record->_next;
+    for (Node *retired : record->_retired)
+      deallocate_node(retired);
+    delete record;
+    record = next_record;
+  }
+}
+
+template <class T, class Alloc>
+Alloc concurrent_queue<T, Alloc>::get_allocator() const {
+  return _allocator;
+}
+
+// Claims the record this thread used last for this queue if it is free,
+// then any free one, and only then adds a new record.
+template <class T, class Alloc>
+typename concurrent_queue<T, Alloc>::Record *
+concurrent_queue<T, Alloc>::acquire_record() const {
+  static thread_local size_t cached_id = 0;
+  static thread_local Record *cached = nullptr;
+
+  bool expected = false;
+  if (cached_id == _id &&
+      cached->_active.compare_exchange_strong(expected, true,
+                                              std::memory_order_acquire))
+    return cached;
+
+  Record *record = _records.load(std::memory_order_acquire);
+  for (; record; record = record->_next) {
+    expected = false;
+    if (!record->_active.load(std::memory_order_relaxed) &&
+        record->_active.compare_exchange_strong(expected, true,
+                                                std::memory_order_acquire))
+      break;
+  }
+
+  if (!record) {
+    record = new Record();
+    record->_active.store(true, std::memory_order_relaxed);
+    for (auto &hazard : record->_hazards)
+      hazard.store(nullptr, std::memory_order_relaxed);
+
+    Record *head = _records.load(std::memory_order_relaxed);
+    do {
+      record->_next = head;
+    } while (!_records.compare_exchange_weak(head, record,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+    _record_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  cached_id = _id;
+  cached = record;
+  return record;
+}
+
+template <class T, class Alloc>
+void concurrent_queue<T, Alloc>::release_record(Record *record) const {
+  for (auto &hazard : record->_hazards)
+    hazard.store(nullptr, std::memory_order_release);
+  record->_active.store(false, std::memory_order_release);
+}
+
+// Publishes the node source points to and rereads source until they agree,
+// so the node cannot have been retired before it was published.
+template <class T, class Alloc>
+typename concurrent_queue<T, Alloc>::Node *
+concurrent_queue<T, Alloc>::protect(Record *record, size_t index,
+                                    const std::atomic<Node *> &source) const {
+  Node *node = source.load(std::memory_order_relaxed);
+  for (;;) {
+    record->_hazards[index].store(node, std::memory_order_seq_cst);
+    Node *current = source.load(std::memory_order_seq_cst);
+    if (current == node)
+      return node;
+    node = current;
+  }
+}
+
+template <class T, class Alloc>
+void concurrent_queue<T, Alloc>::push_back(const T &value) {
+  emplace_back(value);
+}
+
+template <class T, class Alloc>
+void concurrent_queue<T, Alloc>::push_back(T &&value) {
+  emplace_back(std::move(value));
+}
+
+template <class T, class Alloc>
+template <class... Args>
+void concurrent_queue<T, Alloc>::emplace_back(Args &&... args) {
+  Node *node = allocate_node();
+  try {
+    node_traits::construct(_allocator, value(node),
+                           std::forward<Args>(args)...);
+  } catch (...) {
+    deallocate_node(node);
+    throw;
+  }
+
+  Record *record = acquire_record();
+  for (;;) {
+    Node *tail = protect(record, 0, _tail);
+    Node *next = tail->_next.load(std::memory_order_acquire);
+    if (tail != _tail.load(std::memory_order_acquire))
+      continue;
+
+    // Another producer linked a node but has not swung the tail yet.
+    if (next) {
+      _tail.compare_exchange_weak(tail, next, std::memory_order_release,
+                                  std::memory_order_relaxed);
+      continue;
+    }
+
+    if (tail->_next.compare_exchange_weak(next, node,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+      _tail.compare_exchange_strong(tail, node, std::memory_order_release,
+                                    std::memory_order_relaxed);
+      break;
+    }
+  }
+  release_record(record);
+}
+
+// The consumer that moves _head from the dummy to its successor owns the
+// successor's value; the successor becomes the new dummy and the old one is
+// retired.
+template <class T, class Alloc>
+template <class Consume>
+bool concurrent_queue<T, Alloc>::pop(Consume consume) {
+  Record *record = acquire_record();
+  for (;;) {
+    Node *head = protect(record, 0, _head);
+    Node *tail = _tail.load(std::memory_order_acquire);
+    Node *next = head->_next.load(std::memory_order_acquire);
+
+    // While head is still the head, next cannot have been retired.
+    record->_hazards[1].store(next, std::memory_order_seq_cst);
+    if (head != _head.load(std::memory_order_seq_cst))
+      continue;
+
+    if (!next) {
+      release_record(record);
+      return false;
+    }
+
+    if (head == tail) {
+      _tail.compare_exchange_weak(tail, next, std::memory_order_release,
+                                  std::memory_order_relaxed);
+      continue;
+    }
+
+    if (_head.compare_exchange_strong(head, next, std::memory_order_acq_rel,
+                                      std::memory_order_relaxed)) {
+      // The element is off the queue now, so if consume throws it is lost,
+      // but its value is still destroyed and the record released.
+      try {
+        consume(std::move(*value(next)));
+      } catch (...) {
+        finish_pop(record, head, next);
+        throw;
+      }
+      finish_pop(record, head, next);
+      return true;
+    }
+  }
+}
+
+template <class T, class Alloc>
+void concurrent_queue<T, Alloc>::finish_pop(Record *record, Node *old_head,
+                                            Node *new_head) {
+  node_traits::destroy(_allocator, value(new_head));
+  retire(record, old_head);
+  release_record(record);
+}
+
+template <class T, class Alloc>
+bool concurrent_queue<T, Alloc>::try_pop(T &value) {
+  return pop([&value](T &&front) { value = std::move(front); });
+}
+
+template <class T, class Alloc> T concurrent_queue<T, Alloc>::pop_front() {
+  std::optional<T> front;
+  while (!pop([&front](T &&value) { front.emplace(std::move(value)); }))
+    std::this_thread::yield();
+  return std::move(*front);
+}
+
+template <class T, class Alloc> bool concurrent_queue<T, Alloc>::empty() const {
+  Record *record = acquire_record();
+  Node *head = protect(record, 0, _head);
+  const bool result = !head->_next.load(std::memory_order_acquire);
+  release_record(record);
+  return result;
+}
+
+template <class T, class Alloc>
+void concurrent_queue<T, Alloc>::retire(Record *record, Node *node) {
+  record->_retired.push_back(node);
+
+  // Scanning costs a pass over every hazard pointer, so let enough nodes
+  // pile up that most of them can be freed each time.
+  const size_t threshold =
+      2 * HAZARDS_PER_THREAD *
+          _record_count.load(std::memory_order_relaxed) +
+      64;
+  if (record->_retired.size() >= threshold)
+    scan(record);
+}
+
+template <class T, class Alloc>
+void concurrent_queue<T, Alloc>::scan(Record *record) {
+  std::vector<Node *> hazards;
+  for (Record *other = _records.load(std::memory_order_acquire); other;
+       other = other->_next) {
+    for (auto &hazard : other->_hazards) {
+      if (Node *node = hazard.load(std::memory_order_seq_cst))
+        hazards.push_back(node);
+    }
+  }
+  std::sort(hazards.begin(), hazards.end());
+
+  auto kept = record->_retired.begin();
+  for (Node *node : record->_retired) {
+    if (std::binary_search(hazards.begin(), hazards.end(), node))
+      *kept++ = node;
+    else
+      deallocate_node(node);
+  }
+  record->_retired.erase(kept, record->_retired.end());
+}
+
+} // namespace task
@@ -0,0 +1,100 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+namespace task {
+
+// Lock-free multi-producer multi-consumer FIFO queue (Michael & Scott).
+// Producers link new nodes at the tail, consumers advance the head past a
+// dummy node. Nodes unlinked by a consumer are reclaimed through hazard
+// pointers: each operation publishes the nodes it is about to dereference,
+// and a retired node is only deallocated once no thread has published it.
+//
+// Alloc must be safe to call from several threads at once, as
+// std::allocator is.
+template <class T, class Alloc = std::allocator<T>> class concurrent_queue {
+
+private:
+  // The head node is a dummy whose value has already been taken (or never
+  // existed), so _value is constructed and destroyed by hand.
+  struct Node {
+    std::atomic<Node *> _next;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _value;
+  };
+
+  static constexpr size_t HAZARDS_PER_THREAD = 2;
+
+  // Hazard pointers of one thread at a time, claimed through _active for the
+  // duration of an operation. Records are never freed before the queue.
+  struct Record {
+    std::atomic<Node *> _hazards[HAZARDS_PER_THREAD];
+    std::atomic<bool> _active;
+    Record *_next;
+    // Nodes unlinked under this record and not yet deallocated; only the
+    // thread holding the record touches it.
+    std::vector<Node *> _retired;
+  };
+
+  using allocator_type_internal =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+  using node_traits = std::allocator_traits<allocator_type_internal>;
+  allocator_type_internal _allocator;
+
+  // Separate cache lines: producers contend on _tail, consumers on _head.
+  alignas(64) std::atomic<Node *> _head;
+  alignas(64) std::atomic<Node *> _tail;
+  alignas(64) mutable std::atomic<Record *> _records;
+  mutable std::atomic<size_t> _record_count;
+
+  // Distinguishes this queue from earlier ones at the same address in the
+  // per-thread record cache.
+  const size_t _id;
+
+public:
+  concurrent_queue();
+  explicit concurrent_queue(const Alloc &alloc);
+  ~concurrent_queue();
+
+  concurrent_queue(const concurrent_queue &) = delete;
+  concurrent_queue &operator=(const concurrent_queue &) = delete;
+
+  Alloc get_allocator() const;
+
+  void push_back(const T &value);
+  void push_back(T &&value);
+  template <class... Args> void emplace_back(Args &&... args);
+
+  // Moves the front element into value; false if the queue was empty. If
+  // the move assignment throws, the element is dropped.
+  bool try_pop(T &value);
+  // Waits, yielding, until an element is available.
+  T pop_front();
+
+  // A snapshot: other threads may change it at any time.
+  bool empty() const;
+
+private:
+  static size_t next_id();
+  static T *value(Node *node);
+  Node *allocate_node();
+  void deallocate_node(Node *node);
+
+  Record *acquire_record() const;
+  void release_record(Record *record) const;
+  Node *protect(Record *record, size_t index,
+                const std::atomic<Node *> &source) const;
+
+  template <class Consume> bool pop(Consume consume);
+  void finish_pop(Record *record, Node *old_head, Node *new_head);
+
+  void retire(Record *record, Node *node);
+  void scan(Record *record);
+};
+
+} // namespace task
+
+#include "concurrent_queue.cpp"
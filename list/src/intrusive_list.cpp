@@ -0,0 +1,310 @@
+#include "intrusive_list.h"
+
+namespace task {
+
+template <class T, class Hook> void intrusive_list<T, Hook>::init() {
+  _size = 0;
+  _sentinel._next = _sentinel._prev = &_sentinel;
+}
+
+template <class T, class Hook>
+void intrusive_list<T, Hook>::relink_sentinel() {
+  if (_size == 0) {
+    init();
+    return;
+  }
+  _sentinel._next->_prev = &_sentinel;
+  _sentinel._prev->_next = &_sentinel;
+}
+
+// The sentinel's links are copied one by one: copying a hook leaves the
+// copy unlinked.
+template <class T, class Hook>
+void intrusive_list<T, Hook>::steal(intrusive_list &other) {
+  _sentinel._next = other._sentinel._next;
+  _sentinel._prev = other._sentinel._prev;
+  _size = other._size;
+  relink_sentinel();
+  other.init();
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::NodeBase *
+intrusive_list<T, Hook>::to_node(T &value) {
+  return Hook::to_hook(std::addressof(value));
+}
+
+template <class T, class Hook> intrusive_list<T, Hook>::intrusive_list() {
+  init();
+}
+
+template <class T, class Hook> intrusive_list<T, Hook>::~intrusive_list() {
+  clear();
+}
+
+template <class T, class Hook>
+intrusive_list<T, Hook>::intrusive_list(intrusive_list &&other) {
+  steal(other);
+}
+
+template <class T, class Hook>
+intrusive_list<T, Hook> &
+intrusive_list<T, Hook>::operator=(intrusive_list &&other) {
+  if (this == &other)
+    return *this;
+
+  clear();
+  steal(other);
+  return *this;
+}
+
+template <class T, class Hook> T &intrusive_list<T, Hook>::front() {
+  return NodeAccess::value(_sentinel._next);
+}
+
+template <class T, class Hook> const T &intrusive_list<T, Hook>::front() const {
+  return NodeAccess::value(_sentinel._next);
+}
+
+template <class T, class Hook> T &intrusive_list<T, Hook>::back() {
+  return NodeAccess::value(_sentinel._prev);
+}
+
+template <class T, class Hook> const T &intrusive_list<T, Hook>::back() const {
+  return NodeAccess::value(_sentinel._prev);
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::iterator intrusive_list<T, Hook>::begin() {
+  return {_sentinel._next};
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::iterator intrusive_list<T, Hook>::end() {
+  return {&_sentinel};
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::const_iterator
+intrusive_list<T, Hook>::cbegin() const {
+  return {_sentinel._next};
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::const_iterator
+intrusive_list<T, Hook>::cend() const {
+  return {&_sentinel};
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::reverse_iterator
+intrusive_list<T, Hook>::rbegin() {
+  return reverse_iterator(end());
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::reverse_iterator
+intrusive_list<T, Hook>::rend() {
+  return reverse_iterator(begin());
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::const_reverse_iterator
+intrusive_list<T, Hook>::crbegin() const {
+  return const_reverse_iterator(cend());
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::const_reverse_iterator
+intrusive_list<T, Hook>::crend() const {
+  return const_reverse_iterator(cbegin());
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::iterator
+intrusive_list<T, Hook>::iterator_to(T &value) {
+  return {to_node(value)};
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::const_iterator
+intrusive_list<T, Hook>::iterator_to(const T &value) const {
+  return {to_node(const_cast<T &>(value))};
+}
+
+template <class T, class Hook> bool intrusive_list<T, Hook>::empty() const {
+  return _size == 0;
+}
+
+template <class T, class Hook> size_t intrusive_list<T, Hook>::size() const {
+  return _size;
+}
+
+// Leaves every element unlinked, so it can go on another list.
+template <class T, class Hook> void intrusive_list<T, Hook>::clear() {
+  NodeBase *node = _sentinel._next;
+  while (node != &_sentinel) {
+    NodeBase *next = node->_next;
+    node->_next = node->_prev = nullptr;
+    node = next;
+  }
+  init();
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::iterator
+intrusive_list<T, Hook>::insert(const_iterator pos, T &value) {
+  NodeBase *next = const_cast<NodeBase *>(pos._current);
+  NodeBase *node = to_node(value);
+
+  node->_next = next;
+  node->_prev = next->_prev;
+  next->_prev->_next = node;
+  next->_prev = node;
+
+  _size++;
+  return {node};
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::iterator
+intrusive_list<T, Hook>::erase(const_iterator pos) {
+  NodeBase *node = const_cast<NodeBase *>(pos._current);
+  NodeBase *next = node->_next;
+
+  node->_prev->_next = next;
+  next->_prev = node->_prev;
+  node->_next = node->_prev = nullptr;
+
+  _size--;
+  return {next};
+}
+
+template <class T, class Hook>
+typename intrusive_list<T, Hook>::iterator
+intrusive_list<T, Hook>::erase(const_iterator first, const_iterator last) {
+  for (auto itr = first; itr != last;)
+    itr = erase(itr);
+
+  return {const_cast<NodeBase *>(last._current)};
+}
+
+template <class T, class Hook> void intrusive_list<T, Hook>::push_back(T &value) {
+  insert(cend(), value);
+}
+
+template <class T, class Hook> void intrusive_list<T, Hook>::pop_back() {
+  erase(--cend());
+}
+
+template <class T, class Hook>
+void intrusive_list<T, Hook>::push_front(T &value) {
+  insert(cbegin(), value);
+}
+
+template <class T, class Hook> void intrusive_list<T, Hook>::pop_front() {
+  erase(cbegin());
+}
+
+template <class T, class Hook>
+void intrusive_list<T, Hook>::swap(intrusive_list &other) {
+  std::swap(_sentinel._next, other._sentinel._next);
+  std::swap(_sentinel._prev, other._sentinel._prev);
+  std::swap(_size, other._size);
+
+  relink_sentinel();
+  other.relink_sentinel();
+}
+
+template <class T, class Hook>
+void intrusive_list<T, Hook>::merge(intrusive_list &other) {
+  merge(other, std::less<>());
+}
+
+// Stable: on ties elements of *this stay in front of elements of other.
+template <class T, class Hook>
+template <class Compare>
+void intrusive_list<T, Hook>::merge(intrusive_list &other, Compare comp) {
+  if (this == &other || other.empty())
+    return;
+
+  _size += other._size;
+  other._size = 0;
+  detail::merge<NodeAccess>(&_sentinel, &other._sentinel, comp);
+}
+
+template <class T, class Hook>
+void intrusive_list<T, Hook>::splice(const_iterator pos, intrusive_list &other) {
+  splice(pos, other, other.cbegin(), other.cend(), other._size);
+}
+
+template <class T, class Hook>
+void intrusive_list<T, Hook>::splice(const_iterator pos, intrusive_list &other,
+                                     const_iterator it) {
+  splice(pos, other, it, std::next(it), 1);
+}
+
+template <class T, class Hook>
+void intrusive_list<T, Hook>::splice(const_iterator pos, intrusive_list &other,
+                                     const_iterator first,
+                                     const_iterator last) {
+  splice(pos, other, first, last,
+         (this == &other) ? 0 : std::distance(first, last));
+}
+
+template <class T, class Hook>
+void intrusive_list<T, Hook>::splice(const_iterator pos, intrusive_list &other,
+                                     const_iterator first, const_iterator last,
+                                     size_t count) {
+  if (this != &other) {
+    _size += count;
+    other._size -= count;
+  }
+  detail::transfer(const_cast<NodeBase *>(pos._current),
+                   const_cast<NodeBase *>(first._current),
+                   const_cast<NodeBase *>(last._current));
+}
+
+// Unlike task::list, erasing does not destroy anything, so value may be an
+// element of this list.
+template <class T, class Hook>
+size_t intrusive_list<T, Hook>::remove(const T &value) {
+  return remove_if([&value](const T &element) { return element == value; });
+}
+
+template <class T, class Hook>
+template <class UnaryPredicate>
+size_t intrusive_list<T, Hook>::remove_if(UnaryPredicate pred) {
+  return detail::remove_if(
+      cbegin(), cend(), pred,
+      [this](const_iterator it) -> const_iterator { return erase(it); });
+}
+
+template <class T, class Hook> void intrusive_list<T, Hook>::reverse() {
+  detail::reverse(&_sentinel);
+}
+
+template <class T, class Hook> void intrusive_list<T, Hook>::unique() {
+  unique(std::equal_to<>());
+}
+
+template <class T, class Hook>
+template <class BinaryPredicate>
+void intrusive_list<T, Hook>::unique(BinaryPredicate pred) {
+  detail::unique(
+      cbegin(), cend(), pred,
+      [this](const_iterator it) -> const_iterator { return erase(it); });
+}
+
+template <class T, class Hook> void intrusive_list<T, Hook>::sort() {
+  sort(std::less<>());
+}
+
+// The bottom-up merge sort of task::list::sort.
+template <class T, class Hook>
+template <class Compare>
+void intrusive_list<T, Hook>::sort(Compare comp) {
+  detail::sort<NodeAccess>(&_sentinel, comp);
+}
+
+} // namespace task
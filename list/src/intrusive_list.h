@@ -0,0 +1,189 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+
+#include <algorithm>
+#include <functional>
+
+#include "list_links.h"
+
+namespace task {
+
+// The links an object embeds to be put on an intrusive_list. An object can
+// be on as many lists at once as it has hooks; hooks are told apart by Tag
+// when inherited, or by member name.
+template <class Tag = void> struct list_hook {
+  list_hook *_next = nullptr;
+  list_hook *_prev = nullptr;
+
+  list_hook() = default;
+  // Links belong to the object, not to its value: a copy starts off no list,
+  // and assigning to a linked object keeps it where it is.
+  list_hook(const list_hook &) {}
+  list_hook &operator=(const list_hook &) { return *this; }
+
+  bool is_linked() const { return _next != nullptr; }
+};
+
+// T inherits list_hook<Tag>.
+template <class Tag = void> struct base_hook {
+  using hook_type = list_hook<Tag>;
+
+  template <class T> static hook_type *to_hook(T *value) {
+    return static_cast<hook_type *>(value);
+  }
+  template <class T> static T *to_value(hook_type *hook) {
+    return static_cast<T *>(hook);
+  }
+};
+
+// T has a list_hook data member, e.g. member_hook<&Task::ready_hook>. T must
+// not have virtual bases, so the member sits at a fixed offset.
+template <auto Member> struct member_hook;
+
+template <class T, class Tag, list_hook<Tag> T::*Member>
+struct member_hook<Member> {
+  using hook_type = list_hook<Tag>;
+
+  static hook_type *to_hook(T *value) {
+    hook_type *hook = &(value->*Member);
+    if (_offset.load(std::memory_order_relaxed) == UNMEASURED)
+      _offset.store(reinterpret_cast<char *>(hook) -
+                        reinterpret_cast<char *>(value),
+                    std::memory_order_relaxed);
+    return hook;
+  }
+  // hook must have come from to_hook, which has measured the offset by then.
+  // The address is that of the T holding the member, which for U derived
+  // from T need not be where the U starts.
+  template <class U> static U *to_value(hook_type *hook) {
+    const std::ptrdiff_t offset = _offset.load(std::memory_order_relaxed);
+    assert(offset != UNMEASURED);
+    return static_cast<U *>(
+        reinterpret_cast<T *>(reinterpret_cast<char *>(hook) - offset));
+  }
+
+private:
+  static constexpr std::ptrdiff_t UNMEASURED =
+      std::numeric_limits<std::ptrdiff_t>::min();
+
+  // Measured on the first real element passed to to_hook; every element
+  // has the member at the same offset.
+  inline static std::atomic<std::ptrdiff_t> _offset{UNMEASURED};
+};
+
+// A list of objects it does not own: elements are linked through their
+// hooks, so inserting, erasing, splicing, merging and sorting never
+// allocate, copy or move an element. Erased elements, and all elements when
+// the list is cleared or destroyed, are only unlinked; their lifetime is up
+// to the caller, and an element must be erased before it is destroyed.
+template <class T, class Hook = base_hook<>> class intrusive_list {
+
+private:
+  using NodeBase = typename Hook::hook_type;
+
+  // Circular as in task::list; the sentinel is not part of any element.
+  NodeBase _sentinel;
+  size_t _size;
+
+  // How the link code shared with task::list reaches an element.
+  struct NodeAccess {
+    using value_type = T;
+
+    static T &value(NodeBase *node) {
+      return *Hook::template to_value<T>(node);
+    }
+    static const T &value(const NodeBase *node) {
+      return *Hook::template to_value<T>(const_cast<NodeBase *>(node));
+    }
+  };
+
+public:
+  using iterator =
+      detail::link_iterator<intrusive_list, NodeBase, NodeAccess, false>;
+  using const_iterator =
+      detail::link_iterator<intrusive_list, NodeBase, NodeAccess, true>;
+
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  intrusive_list();
+  ~intrusive_list();
+
+  intrusive_list(const intrusive_list &) = delete;
+  intrusive_list &operator=(const intrusive_list &) = delete;
+  intrusive_list(intrusive_list &&other);
+  intrusive_list &operator=(intrusive_list &&other);
+
+  T &front();
+  const T &front() const;
+
+  T &back();
+  const T &back() const;
+
+  iterator begin();
+  iterator end();
+
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+
+  reverse_iterator rbegin();
+  reverse_iterator rend();
+
+  const_reverse_iterator crbegin() const;
+  const_reverse_iterator crend() const;
+
+  // The position of an element known to be on this list, in O(1).
+  iterator iterator_to(T &value);
+  const_iterator iterator_to(const T &value) const;
+
+  bool empty() const;
+  size_t size() const;
+  void clear();
+
+  iterator insert(const_iterator pos, T &value);
+
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last);
+
+  void push_back(T &value);
+  void pop_back();
+
+  void push_front(T &value);
+  void pop_front();
+
+  void swap(intrusive_list &other);
+
+  void merge(intrusive_list &other);
+  template <class Compare> void merge(intrusive_list &other, Compare comp);
+
+  void splice(const_iterator pos, intrusive_list &other);
+  void splice(const_iterator pos, intrusive_list &other, const_iterator it);
+  void splice(const_iterator pos, intrusive_list &other, const_iterator first,
+              const_iterator last);
+  // O(1): the caller passes std::distance(first, last) as count.
+  void splice(const_iterator pos, intrusive_list &other, const_iterator first,
+              const_iterator last, size_t count);
+
+  size_t remove(const T &value);
+  template <class UnaryPredicate> size_t remove_if(UnaryPredicate pred);
+  void reverse();
+  void unique();
+  template <class BinaryPredicate> void unique(BinaryPredicate pred);
+  void sort();
+  template <class Compare> void sort(Compare comp);
+
+private:
+  void init();
+  void relink_sentinel();
+  void steal(intrusive_list &other);
+
+  static NodeBase *to_node(T &value);
+};
+
+} // namespace task
+
+#include "intrusive_list.cpp"
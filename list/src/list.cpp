@@ -4,236 +4,228 @@ namespace task {
 
 template <class T, class Alloc> void list<T, Alloc>::init() {
   _size = 0;
-
-  _head = _allocator.allocate(1);
-  _back = _allocator.allocate(1);
-  _head->_next = _back;
-  _back->_prev = _head;
-  _back->_next = nullptr;
-  _head->_prev = nullptr;
-}
-
-template <class T, class Alloc> list<T, Alloc>::iterator::iterator() {
-  _current = nullptr;
-}
-
-template <class T, class Alloc>
-list<T, Alloc>::iterator::iterator(const iterator &other) {
-  _current = other._current;
-}
-template <class T, class Alloc>
-list<T, Alloc>::iterator::iterator(list::Node *p) : _current{p} {}
-
-template <class T, class Alloc>
-typename list<T, Alloc>::iterator &list<T, Alloc>::iterator::operator=(
-    const task::list<T, Alloc>::iterator &other) {
-  _current = other._current;
-  return *this;
-}
-
-template <class T, class Alloc>
-typename list<T, Alloc>::iterator &list<T, Alloc>::iterator::operator++() {
-  _current = _current->_next;
-  return *this;
-}
-
-template <class T, class Alloc>
-typename list<T, Alloc>::iterator list<T, Alloc>::iterator::operator++(int) {
-  iterator it = *this;
-  _current = _current->_next;
-  return it;
-}
-
-template <class T, class Alloc>
-typename list<T, Alloc>::iterator::reference
-    list<T, Alloc>::iterator::operator*() const {
-  return _current->_value;
-}
-
-template <class T, class Alloc>
-typename list<T, Alloc>::iterator::pointer
-    list<T, Alloc>::iterator::operator->() const {
-  return &(_current->_value);
-}
-
-template <class T, class Alloc>
-typename list<T, Alloc>::iterator &list<T, Alloc>::iterator::operator--() {
-  _current = _current->_prev;
-  return *this;
-}
-
-template <class T, class Alloc>
-typename list<T, Alloc>::iterator list<T, Alloc>::iterator::operator--(int) {
-  iterator it = *this;
-  _current = _current->_prev;
-  return it;
+  _sentinel._next = _sentinel._prev = &_sentinel;
 }
 
-template <class T, class Alloc>
-bool list<T, Alloc>::iterator::operator==(iterator other) const {
-  return _current == other._current;
+// After _sentinel has been copied from another list, points the boundary
+// nodes back at it.
+template <class T, class Alloc> void list<T, Alloc>::relink_sentinel() {
+  if (_size == 0) {
+    init();
+    return;
+  }
+  _sentinel._next->_prev = &_sentinel;
+  _sentinel._prev->_next = &_sentinel;
 }
 
-template <class T, class Alloc>
-bool list<T, Alloc>::iterator::operator!=(iterator other) const {
-  return _current != other._current;
+// Takes over the nodes of other in O(1), leaving it empty. The allocators
+// must compare equal; free nodes stay with other.
+template <class T, class Alloc> void list<T, Alloc>::steal(list &other) {
+  _sentinel = other._sentinel;
+  _size = other._size;
+  relink_sentinel();
+  other.init();
 }
 
 template <class T, class Alloc>
-list<T, Alloc>::const_iterator::const_iterator() {
-  _current = nullptr;
+typename list<T, Alloc>::Node *list<T, Alloc>::acquire_node() {
+  if (_free_nodes) {
+    Node *node = static_cast<Node *>(_free_nodes);
+    _free_nodes = node->_next;
+    return node;
+  }
+  return node_traits::allocate(_allocator, 1);
 }
 
 template <class T, class Alloc>
-list<T, Alloc>::const_iterator::const_iterator(const const_iterator &other) {
-  _current = other._current;
+void list<T, Alloc>::recycle_node(Node *node) {
+  node->_next = _free_nodes;
+  _free_nodes = node;
 }
 
+// Builds the value directly inside a node; the node is not linked yet.
 template <class T, class Alloc>
-list<T, Alloc>::const_iterator::const_iterator(const iterator &other) {
-  _current = other._current;
+template <class... Args>
+typename list<T, Alloc>::Node *list<T, Alloc>::create_node(Args &&... args) {
+  Node *node = acquire_node();
+  try {
+    node_traits::construct(_allocator, std::addressof(node->_value),
+                           std::forward<Args>(args)...);
+  } catch (...) {
+    recycle_node(node);
+    throw;
+  }
+  return node;
 }
 
 template <class T, class Alloc>
-typename list<T, Alloc>::const_iterator &
-list<T, Alloc>::const_iterator::operator=(
-    const task::list<T, Alloc>::const_iterator &other) {
-  _current = other._current;
-  return *this;
+void list<T, Alloc>::destroy_node(Node *node) {
+  node_traits::destroy(_allocator, std::addressof(node->_value));
+  recycle_node(node);
 }
 
 template <class T, class Alloc>
-typename list<T, Alloc>::const_iterator &
-list<T, Alloc>::const_iterator::operator++() {
-  _current = _current->_next;
-  return *this;
-}
+typename list<T, Alloc>::iterator list<T, Alloc>::link_node(const_iterator pos,
+                                                            Node *node) {
+  NodeBase *next = const_cast<NodeBase *>(pos._current);
 
-template <class T, class Alloc>
-typename list<T, Alloc>::const_iterator
-list<T, Alloc>::const_iterator::operator++(int) {
-  const_iterator it = *this;
-  _current = _current->_next;
-  return it;
-}
+  node->_next = next;
+  node->_prev = next->_prev;
+  next->_prev->_next = node;
+  next->_prev = node;
 
-template <class T, class Alloc>
-typename list<T, Alloc>::const_iterator::reference
-    list<T, Alloc>::const_iterator::operator*() const {
-  return _current->_value;
+  _size++;
+  return {node};
 }
 
+// Builds nodes from make_node() until it returns nullptr into a detached
+// chain, then links the whole chain in front of pos. If a constructor
+// throws, the nodes built so far are destroyed and the list is unchanged.
 template <class T, class Alloc>
-typename list<T, Alloc>::const_iterator::pointer
-    list<T, Alloc>::const_iterator::operator->() const {
-  return &(_current->_value);
-}
+template <class NodeFactory>
+typename list<T, Alloc>::iterator
+list<T, Alloc>::link_chain(const_iterator pos, NodeFactory make_node) {
+  NodeBase *next = const_cast<NodeBase *>(pos._current);
+  NodeBase head{nullptr, nullptr};
+  NodeBase *tail = &head;
+  size_t count = 0;
+
+  try {
+    while (Node *node = make_node()) {
+      tail->_next = node;
+      tail = node;
+      count++;
+    }
+  } catch (...) {
+    for (NodeBase *node = head._next; count > 0; count--) {
+      NodeBase *following = node->_next;
+      destroy_node(static_cast<Node *>(node));
+      node = following;
+    }
+    throw;
+  }
 
-template <class T, class Alloc>
-typename list<T, Alloc>::const_iterator &
-list<T, Alloc>::const_iterator::operator--() {
-  _current = _current->_prev;
-  return *this;
-}
+  if (count == 0)
+    return {next};
 
-template <class T, class Alloc>
-typename list<T, Alloc>::const_iterator
-list<T, Alloc>::const_iterator::operator--(int) {
-  iterator it = *this;
-  _current = _current->_prev;
-  return it;
-}
+  NodeBase *prev = next->_prev;
+  for (NodeBase *node = head._next; node != tail; node = node->_next)
+    node->_next->_prev = node;
 
-template <class T, class Alloc>
-bool list<T, Alloc>::const_iterator::operator==(const_iterator other) const {
-  return _current == other._current;
-}
+  prev->_next = head._next;
+  head._next->_prev = prev;
+  tail->_next = next;
+  next->_prev = tail;
 
-template <class T, class Alloc>
-bool list<T, Alloc>::const_iterator::operator!=(const_iterator other) const {
-  return _current != other._current;
+  _size += count;
+  return {head._next};
 }
 
-template <class T, class Alloc> list<T, Alloc>::list() { init(); }
+template <class T, class Alloc> list<T, Alloc>::list() : list(Alloc()) {}
 
 template <class T, class Alloc>
-list<T, Alloc>::list(const Alloc &alloc) : list<T, Alloc>() {
-  _allocator = alloc;
+list<T, Alloc>::list(const Alloc &alloc) : _allocator(alloc) {
+  init();
 }
 
 template <class T, class Alloc>
 list<T, Alloc>::list(size_t count, const T &value, const Alloc &alloc)
     : list<T, Alloc>(alloc) {
-  while (_size < count) {
-    push_back(value);
-  }
+  insert(cend(), count, value);
 }
 
 template <class T, class Alloc>
 list<T, Alloc>::list(size_t count, const Alloc &alloc) : list<T, Alloc>(alloc) {
   while (_size < count) {
-    Node *node = _allocator.allocate(1);
-    _allocator.construct(node, _back, _back->_prev);
-    _back->_prev = _back->_prev->_next = node;
-    _size++;
+    emplace_back();
   }
 }
 
+template <class T, class Alloc>
+template <class InputIt, class>
+list<T, Alloc>::list(InputIt first, InputIt last, const Alloc &alloc)
+    : list<T, Alloc>(alloc) {
+  insert(cend(), first, last);
+}
+
 template <class T, class Alloc> list<T, Alloc>::~list() {
   clear();
-  _allocator.deallocate(_head, 1);
-  _allocator.deallocate(_back, 1);
+  shrink_to_fit();
 }
 
 template <class T, class Alloc>
-list<T, Alloc>::list(const list &other) : list<T, Alloc>() {
-  for (const_iterator it = other.cbegin(); it != other.cend(); it++) {
-    push_back(*it);
-  }
-}
+list<T, Alloc>::list(const list &other)
+    : list<T, Alloc>(other.cbegin(), other.cend(),
+                     std::allocator_traits<Alloc>::
+                         select_on_container_copy_construction(
+                             other.get_allocator())) {}
 
 template <class T, class Alloc>
-list<T, Alloc>::list(list &&other) : list<T, Alloc>() {
-  _size = other._size;
-  other._size = 0;
-
-  _head->_next = other._head->_next;
-  _head->_next->_prev = _head;
-
-  _back->_prev = other._back->_prev;
-  _back->_prev->_next = _back;
-
-  other._head->_next = other._back;
-  other._back->_prev = other._head;
+list<T, Alloc>::list(list &&other) noexcept
+    : _allocator(std::move(other._allocator)) {
+  steal(other);
 }
 
 template <class T, class Alloc>
 list<T, Alloc> &list<T, Alloc>::operator=(const list &other) {
-  clear();
-
-  for (const_iterator it = other.cbegin(); it != other.cend(); it++) {
-    push_back(*it);
+  if (this == &other)
+    return *this;
+
+  if (node_traits::propagate_on_container_copy_assignment::value &&
+      _allocator != other._allocator) {
+    clear();
+    shrink_to_fit();
+    _allocator = other._allocator;
   }
 
-  return *this;
-}
-
-template <class T, class Alloc>
-list<T, Alloc> &list<T, Alloc>::operator=(list &&other) {
-  clear();
+  // Assign over the nodes we already have, then trim or extend.
+  iterator dest = begin();
+  const_iterator src = other.cbegin();
+  for (; dest != end() && src != other.cend(); ++dest, ++src)
+    *dest = *src;
 
-  _head->_next = other._head->_next;
-  _head->_next->_prev = _head;
+  if (src == other.cend())
+    erase(dest, cend());
+  else
+    insert(cend(), src, other.cend());
 
-  _back->_prev = other._back->_prev;
-  _back->_prev->_next = _back;
-
-  _size = other._size;
-
-  other._head->_next = other._back;
-  other._back->_prev = other._head;
+  return *this;
+}
 
-  other._size = 0;
+// Steals the nodes of other unless it uses an unequal allocator that does
+// not propagate; only then are the elements moved one by one.
+template <class T, class Alloc>
+list<T, Alloc> &list<T, Alloc>::operator=(list &&other) noexcept(
+    node_traits::propagate_on_container_move_assignment::value ||
+    node_traits::is_always_equal::value) {
+  if (this == &other)
+    return *this;
+
+  if constexpr (node_traits::propagate_on_container_move_assignment::value) {
+    clear();
+    if (_allocator != other._allocator)
+      shrink_to_fit();
+    _allocator = std::move(other._allocator);
+    steal(other);
+  } else if constexpr (node_traits::is_always_equal::value) {
+    clear();
+    steal(other);
+  } else if (_allocator == other._allocator) {
+    clear();
+    steal(other);
+  } else {
+    iterator dest = begin();
+    iterator src = other.begin();
+    for (; dest != end() && src != other.end(); ++dest, ++src)
+      *dest = std::move(*src);
+
+    if (src == other.end())
+      erase(dest, cend());
+    else
+      insert(cend(), std::make_move_iterator(src),
+             std::make_move_iterator(other.end()));
+    other.clear();
+  }
   return *this;
 }
 
@@ -242,49 +234,51 @@ template <class T, class Alloc> Alloc list<T, Alloc>::get_allocator() const {
 }
 
 template <class T, class Alloc> T &list<T, Alloc>::front() {
-  return _head->_next->_value;
+  return NodeAccess::value(_sentinel._next);
 }
 
 template <class T, class Alloc> const T &list<T, Alloc>::front() const {
-  return _head->_next->_value;
+  return NodeAccess::value(_sentinel._next);
 }
 
 template <class T, class Alloc> T &list<T, Alloc>::back() {
-  return _back->_prev->_value;
+  return NodeAccess::value(_sentinel._prev);
 }
 
 template <class T, class Alloc> const T &list<T, Alloc>::back() const {
-  return _back->_prev->_value;
+  return NodeAccess::value(_sentinel._prev);
 }
 
 template <class T, class Alloc>
 typename list<T, Alloc>::iterator list<T, Alloc>::begin() {
-  return {_head->_next};
+  return {_sentinel._next};
 }
 
 template <class T, class Alloc>
 typename list<T, Alloc>::iterator list<T, Alloc>::end() {
-  return {_back};
+  return {&_sentinel};
 }
 
 template <class T, class Alloc>
 typename list<T, Alloc>::const_iterator list<T, Alloc>::cbegin() const {
-  return {_head->_next};
+  return {_sentinel._next};
 }
 
 template <class T, class Alloc>
 typename list<T, Alloc>::const_iterator list<T, Alloc>::cend() const {
-  return {_back};
+  return {&_sentinel};
 }
 
 template <class T, class Alloc>
 typename task::list<T, Alloc>::reverse_iterator list<T, Alloc>::rbegin() {
-  return {_back->_prev};
+  reverse_iterator it(end());
+  return it;
 }
 
 template <class T, class Alloc>
 typename list<T, Alloc>::reverse_iterator list<T, Alloc>::rend() {
-  return {_head};
+  reverse_iterator it(begin());
+  return it;
 }
 
 template <class T, class Alloc>
@@ -307,7 +301,7 @@ template <class T, class Alloc> size_t list<T, Alloc>::size() const {
   return _size;
 }
 template <class T, class Alloc> size_t list<T, Alloc>::max_size() const {
-  return _allocator.max_size();
+  return node_traits::max_size(_allocator);
 }
 
 template <class T, class Alloc> void list<T, Alloc>::clear() {
@@ -318,27 +312,40 @@ template <class T, class Alloc> void list<T, Alloc>::clear() {
 template <class T, class Alloc>
 typename list<T, Alloc>::iterator
 list<T, Alloc>::insert(const_iterator pos, size_t count, const T &value) {
+  return link_chain(pos, [&]() -> Node * {
+    if (count == 0)
+      return nullptr;
+    count--;
+    return create_node(value);
+  });
+}
 
-  iterator iter;
-  for (auto i = 0; i < count; i++) {
-    iter = insert(pos, value);
-  }
-  return iter;
+template <class T, class Alloc>
+template <class InputIt, class>
+typename list<T, Alloc>::iterator
+list<T, Alloc>::insert(const_iterator pos, InputIt first, InputIt last) {
+  return link_chain(pos, [&]() -> Node * {
+    if (first == last)
+      return nullptr;
+    Node *node = create_node(*first);
+    ++first;
+    return node;
+  });
 }
 
 template <class T, class Alloc>
 typename list<T, Alloc>::iterator list<T, Alloc>::erase(const_iterator pos) {
-  auto *node = pos._current;
+  auto *node = static_cast<Node *>(const_cast<NodeBase *>(pos._current));
+  NodeBase *next = node->_next;
 
-  node->_prev->_next = node->_next;
-  node->_next->_prev = node->_prev;
+  node->_prev->_next = next;
+  next->_prev = node->_prev;
 
-  _allocator.destroy(node);
-  _allocator.deallocate(const_cast<Node *>(node), 1);
+  destroy_node(node);
 
   _size--;
 
-  return {node->_next};
+  return {next};
 }
 
 template <class T, class Alloc>
@@ -347,7 +354,7 @@ typename list<T, Alloc>::iterator list<T, Alloc>::erase(const_iterator first,
   for (auto itr = first; itr != last;)
     itr = erase(itr);
 
-  return {const_cast<Node *>(last._current)};
+  return {const_cast<NodeBase *>(last._current)};
 }
 
 template <class T, class Alloc> void list<T, Alloc>::push_back(const T &value) {
@@ -372,23 +379,13 @@ template <class T, class Alloc> void list<T, Alloc>::push_front(T &&value) {
 }
 
 template <class T, class Alloc> void list<T, Alloc>::pop_front() {
-  auto bei = cbegin();
   erase(cbegin());
 }
 
 template <class T, class Alloc>
 typename list<T, Alloc>::iterator list<T, Alloc>::insert(const_iterator pos,
                                                          T &&value) {
-  _size++;
-  Node *prev = pos._current->_prev;
-  Node *node = _allocator.allocate(1);
-
-  _allocator.construct(node, std::move(value), prev->_next, prev);
-
-  prev->_next->_prev = node;
-  prev->_next = node;
-
-  return {node};
+  return link_node(pos, create_node(std::move(value)));
 }
 
 template <class T, class Alloc>
@@ -396,24 +393,7 @@ template <class... Args>
 typename list<T, Alloc>::iterator
 list<T, Alloc>::emplace(typename list<T, Alloc>::const_iterator pos,
                         Args &&... args) {
-  Node *prev = pos._current->_prev;
-
-  Alloc t_allocator;
-
-  Node *node = _allocator.allocate(1);
-  T *data = t_allocator.allocate(1);
-
-  t_allocator.construct(data, std::forward<Args>(args)...);
-  _allocator.construct(node, std::move(*data), prev->_next, prev);
-
-  t_allocator.destroy(data);
-  t_allocator.deallocate(data, 1);
-
-  prev->_next->_prev = node;
-  prev->_next = node;
-
-  _size++;
-  return {pos._current->_prev};
+  return link_node(pos, create_node(std::forward<Args>(args)...));
 }
 
 template <class T, class Alloc>
@@ -431,16 +411,7 @@ void list<T, Alloc>::emplace_front(Args &&... args) {
 template <class T, class Alloc>
 typename list<T, Alloc>::iterator list<T, Alloc>::insert(const_iterator pos,
                                                          const T &value) {
-  Node *prev = pos._current->_prev;
-  Node *node = _allocator.allocate(1);
-
-  _allocator.construct(node, value, prev->_next, prev);
-
-  prev->_next->_prev = node;
-  prev->_next = node;
-
-  _size++;
-  return {node};
+  return link_node(pos, create_node(value));
 }
 
 template <class T, class Alloc> void list<T, Alloc>::resize(size_t count) {
@@ -449,124 +420,145 @@ template <class T, class Alloc> void list<T, Alloc>::resize(size_t count) {
       pop_back();
   } else if (size() < count) {
     while (size() < count)
-      push_back(T());
+      emplace_back();
   }
 }
 
-template <class T, class Alloc> void list<T, Alloc>::swap(list &other) {
-  Node *temp = _head;
-  _head = other._head;
-
-  other._head = temp;
-  temp = other._back;
-  other._back = _back;
+// Free nodes travel with the allocator they came from. Without
+// propagate_on_container_swap the allocators must compare equal.
+template <class T, class Alloc>
+void list<T, Alloc>::swap(list &other) noexcept {
+  if constexpr (node_traits::propagate_on_container_swap::value) {
+    using std::swap;
+    swap(_allocator, other._allocator);
+  }
+  std::swap(_sentinel, other._sentinel);
+  std::swap(_size, other._size);
+  std::swap(_free_nodes, other._free_nodes);
 
-  _back = temp;
-  size_t s = _size;
+  relink_sentinel();
+  other.relink_sentinel();
+}
 
-  _size = other._size;
-  other._size = s;
+template <class T, class Alloc> void list<T, Alloc>::shrink_to_fit() {
+  while (_free_nodes) {
+    Node *node = static_cast<Node *>(_free_nodes);
+    _free_nodes = node->_next;
+    node_traits::deallocate(_allocator, node, 1);
+  }
 }
 
 template <class T, class Alloc> void list<T, Alloc>::merge(list &other) {
-  if (!other.empty()) {
-    _size += other._size;
-    other._size = 0;
+  merge(other, std::less<>());
+}
 
-    Node *node = other._head->_next;
-    Node *temp = _head->_next;
+// Stable: on ties elements of *this stay in front of elements of other.
+template <class T, class Alloc>
+template <class Compare>
+void list<T, Alloc>::merge(list &other, Compare comp) {
+  if (this == &other || other.empty())
+    return;
 
-    while (node != other._back) {
-      while (temp != _back && node->_value > temp->_value)
-        temp = temp->_next;
+  _size += other._size;
+  other._size = 0;
+  detail::merge<NodeAccess>(&_sentinel, &other._sentinel, comp);
+}
 
-      Node *next = node->_next;
-      node->_prev = temp->_prev;
-      node->_next = temp;
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list &other) {
+  splice(pos, other, other.cbegin(), other.cend(), other._size);
+}
 
-      temp->_prev->_next = node;
-      temp->_prev = node;
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list &other,
+                            const_iterator it) {
+  splice(pos, other, it, std::next(it), 1);
+}
 
-      node = next;
-    }
-    other._head->_next = other._back;
-    other._back->_prev = other._head;
-  }
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list &other,
+                            const_iterator first, const_iterator last) {
+  splice(pos, other, first, last,
+         (this == &other) ? 0 : std::distance(first, last));
 }
 
 template <class T, class Alloc>
-void list<T, Alloc>::splice(const_iterator pos, list &other) {
-  if (!other.empty()) {
-    _size += other._size;
-    other._size = 0;
-
-    Node *node = const_cast<Node *>(pos._current);
-    node->_prev->_next = other._head->_next;
-    node->_prev = other._back->_prev;
-
-    other._head->_next->_prev = node->_prev;
-    other._back->_prev->_next = node;
-    other._head->_next = other._back;
-    other._back->_prev = other._head;
+void list<T, Alloc>::splice(const_iterator pos, list &other,
+                            const_iterator first, const_iterator last,
+                            size_t count) {
+  if (this != &other) {
+    _size += count;
+    other._size -= count;
   }
+  detail::transfer(const_cast<NodeBase *>(pos._current),
+                   const_cast<NodeBase *>(first._current),
+                   const_cast<NodeBase *>(last._current));
 }
 
+// value may refer to an element of this list, so that node is erased last.
 template <class T, class Alloc>
-void task::list<T, Alloc>::remove(const T &value) {
-  iterator iter = begin();
-  list<iterator> removed;
+size_t task::list<T, Alloc>::remove(const T &value) {
+  size_t removed = 0;
+  const_iterator deferred = cend();
 
-  while (iter != end()) {
+  for (const_iterator iter = cbegin(); iter != cend();) {
     if (*iter == value) {
-      removed.push_back(iter);
+      if (std::addressof(*iter) == std::addressof(value)) {
+        deferred = iter++;
+        continue;
+      }
+      iter = erase(iter);
+      removed++;
+    } else {
+      ++iter;
     }
-    iter++;
   }
 
-  for (auto it = removed.begin(); it != removed.end(); ++it) {
-    erase(*it);
+  if (deferred != cend()) {
+    erase(deferred);
+    removed++;
   }
+  return removed;
+}
+
+template <class T, class Alloc>
+template <class UnaryPredicate>
+size_t task::list<T, Alloc>::remove_if(UnaryPredicate pred) {
+  return detail::remove_if(
+      cbegin(), cend(), pred,
+      [this](const_iterator it) -> const_iterator { return erase(it); });
 }
 
 template <class T, class Alloc> void task::list<T, Alloc>::reverse() {
-  if (!empty()) {
-    auto current_ptr = _head;
-    while (current_ptr != nullptr) {
-      std::swap(current_ptr->_next, current_ptr->_prev);
-      current_ptr = current_ptr->_prev;
-    }
-    std::swap(_head, _back);
-  }
+  detail::reverse(&_sentinel);
 }
 
 template <class T, class Alloc> void task::list<T, Alloc>::unique() {
-  iterator iter = begin();
-  while (iter != --end()) {
-    if (*iter == *(++iter)) {
-      iter = erase(iter);
-      iter--;
-    }
-  }
+  unique(std::equal_to<>());
+}
+
+template <class T, class Alloc>
+template <class BinaryPredicate>
+void task::list<T, Alloc>::unique(BinaryPredicate pred) {
+  detail::unique(
+      cbegin(), cend(), pred,
+      [this](const_iterator it) -> const_iterator { return erase(it); });
 }
 
 template <class T, class Alloc> void task::list<T, Alloc>::sort() {
-  if (size() < 1)
-    return;
-  else {
-    auto current = _head->_next;
-    while (current->_next != nullptr) {
-      auto index = current->_next;
-      while (index != nullptr && index->_next != nullptr) {
-        if (current->_value > index->_value) {
-          auto temp = current->_value;
-          current->_value = index->_value;
-          index->_value = temp;
-        }
-        index = index->_next;
-      }
-      current = current->_next;
-    }
-  }
+  sort(std::less<>());
+}
+
+// Only links are changed, so no element is copied or moved.
+template <class T, class Alloc>
+template <class Compare>
+void task::list<T, Alloc>::sort(Compare comp) {
+  detail::sort<NodeAccess>(&_sentinel, comp);
+}
+
+template <class T, class Alloc>
+void swap(list<T, Alloc> &lhs, list<T, Alloc> &rhs) noexcept {
+  lhs.swap(rhs);
 }
 
 } // namespace task
\ No newline at end of file
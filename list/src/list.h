@@ -3,105 +3,84 @@
 #include <list>
 
 #include <algorithm>
+#include <functional>
+#include <type_traits>
 #include <vector>
 
+#include "list_links.h"
+
 namespace task {
 template <class T, class Alloc = std::allocator<T>> class list {
 
 private:
-  struct Node {
-    T _value;
-    Node *_next;
-    Node *_prev;
+  struct NodeBase {
+    NodeBase *_next;
+    NodeBase *_prev;
+  };
 
-    Node(Node *n, Node *p) : _value(T()), _next(n), _prev(p){};
-    Node(const T &d, Node *n, Node *p) : _value(d), _next(n), _prev(p){};
-    Node(T &&d, Node *n, Node *p) : _value(std::move(d)), _next(n), _prev(p){};
+  // Never constructed as a whole: create_node() fills in the links and
+  // builds _value in place through the allocator.
+  struct Node : NodeBase {
+    T _value;
   };
 
   using allocator_type_internal =
       typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+  using node_traits = std::allocator_traits<allocator_type_internal>;
   allocator_type_internal _allocator;
 
-  Node *_head;
-  Node *_back;
+  // Circular: _sentinel._next is the first node and _sentinel._prev the
+  // last one; an empty list points at itself and owns no nodes.
+  NodeBase _sentinel;
   size_t _size;
 
-public:
-  class iterator {
-  public:
-    using difference_type = ptrdiff_t;
-    using value_type = T;
-    using pointer = T *;
-    using reference = T &;
-    using iterator_category = std::bidirectional_iterator_tag;
-
-    iterator();
-    iterator(const iterator &);
-    iterator &operator=(const iterator &);
-
-    iterator &operator++();
-    iterator operator++(int);
-    reference operator*() const;
-    pointer operator->() const;
-    iterator &operator--();
-    iterator operator--(int);
-
-    bool operator==(iterator other) const;
-    bool operator!=(iterator other) const;
-
-  protected:
-    iterator(Node *p);
-    friend class list;
-
-  private:
-    Node *_current;
-  };
+  // Erased nodes are kept here, linked through _next, for reuse by inserts.
+  NodeBase *_free_nodes = nullptr;
 
-  class const_iterator {
-  public:
-    using difference_type = ptrdiff_t;
+  // How the link code shared with intrusive_list reaches an element.
+  struct NodeAccess {
     using value_type = T;
-    using pointer = const T *;
-    using reference = const T &;
-    using iterator_category = std::bidirectional_iterator_tag;
-
-    const_iterator();
-    const_iterator(const const_iterator &);
-    const_iterator(const iterator &);
-    const_iterator &operator=(const const_iterator &);
-
-    const_iterator &operator++();
-    const_iterator operator++(int);
-    reference operator*() const;
-    pointer operator->() const;
-    const_iterator &operator--();
-    const_iterator operator--(int);
-
-    bool operator==(const_iterator other) const;
-    bool operator!=(const_iterator other) const;
-
-  protected:
-    friend class list;
-
-  private:
-    const Node *_current;
+
+    static T &value(NodeBase *node) {
+      return static_cast<Node *>(node)->_value;
+    }
+    static const T &value(const NodeBase *node) {
+      return static_cast<const Node *>(node)->_value;
+    }
   };
 
+public:
+  using iterator = detail::link_iterator<list, NodeBase, NodeAccess, false>;
+  using const_iterator =
+      detail::link_iterator<list, NodeBase, NodeAccess, true>;
+
   using reverse_iterator = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+private:
+  // Keeps list(5, 3) from being taken for a range of two ints.
+  template <class InputIt>
+  using RequireInputIterator = std::enable_if_t<std::is_convertible<
+      typename std::iterator_traits<InputIt>::iterator_category,
+      std::input_iterator_tag>::value>;
+
+public:
+
   list();
   explicit list(const Alloc &alloc);
   list(size_t count, const T &value, const Alloc &alloc = Alloc());
   explicit list(size_t count, const Alloc &alloc = Alloc());
+  template <class InputIt, class = RequireInputIterator<InputIt>>
+  list(InputIt first, InputIt last, const Alloc &alloc = Alloc());
 
   ~list();
 
   list(const list &other);
-  list(list &&other);
+  list(list &&other) noexcept;
   list &operator=(const list &other);
-  list &operator=(list &&other);
+  list &operator=(list &&other) noexcept(
+      node_traits::propagate_on_container_move_assignment::value ||
+      node_traits::is_always_equal::value);
 
   Alloc get_allocator() const;
 
@@ -131,6 +110,8 @@ public:
   iterator insert(const_iterator pos, const T &value);
   iterator insert(const_iterator pos, T &&value);
   iterator insert(const_iterator pos, size_t count, const T &value);
+  template <class InputIt, class = RequireInputIterator<InputIt>>
+  iterator insert(const_iterator pos, InputIt first, InputIt last);
 
   iterator erase(const_iterator pos);
   iterator erase(const_iterator first, const_iterator last);
@@ -151,20 +132,46 @@ public:
   template <class... Args> void emplace_front(Args &&... args);
 
   void resize(size_t count);
-  void swap(list &other);
+  void swap(list &other) noexcept;
+  void shrink_to_fit();
 
   void merge(list &other);
+  template <class Compare> void merge(list &other, Compare comp);
+
   void splice(const_iterator pos, list &other);
-  void remove(const T &value);
+  void splice(const_iterator pos, list &other, const_iterator it);
+  void splice(const_iterator pos, list &other, const_iterator first,
+              const_iterator last);
+  // O(1): the caller passes std::distance(first, last) as count.
+  void splice(const_iterator pos, list &other, const_iterator first,
+              const_iterator last, size_t count);
+
+  size_t remove(const T &value);
+  template <class UnaryPredicate> size_t remove_if(UnaryPredicate pred);
   void reverse();
   void unique();
+  template <class BinaryPredicate> void unique(BinaryPredicate pred);
   void sort();
+  template <class Compare> void sort(Compare comp);
 
 private:
   void init();
+  void relink_sentinel();
+  void steal(list &other);
+
+  Node *acquire_node();
+  void recycle_node(Node *node);
+
+  template <class... Args> Node *create_node(Args &&... args);
+  void destroy_node(Node *node);
+  iterator link_node(const_iterator pos, Node *node);
+  template <class NodeFactory>
+  iterator link_chain(const_iterator pos, NodeFactory make_node);
 };
 
-// Your template function definitions may go here...
+template <class T, class Alloc>
+void swap(list<T, Alloc> &lhs, list<T, Alloc> &rhs) noexcept;
+
 } // namespace task
 
 #include "list.cpp"
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "list_links.h"
+
+namespace task::detail {
+
+template <class Owner, class NodeBase, class Access, bool Const>
+link_iterator<Owner, NodeBase, Access, Const>::link_iterator()
+    : _current{nullptr} {}
+
+template <class Owner, class NodeBase, class Access, bool Const>
+template <bool C, class>
+link_iterator<Owner, NodeBase, Access, Const>::link_iterator(
+    const link_iterator<Owner, NodeBase, Access, false> &other)
+    : _current{other._current} {}
+
+template <class Owner, class NodeBase, class Access, bool Const>
+link_iterator<Owner, NodeBase, Access, Const>::link_iterator(node_pointer p)
+    : _current{p} {}
+
+template <class Owner, class NodeBase, class Access, bool Const>
+link_iterator<Owner, NodeBase, Access, Const> &
+link_iterator<Owner, NodeBase, Access, Const>::operator++() {
+  _current = _current->_next;
+  return *this;
+}
+
+template <class Owner, class NodeBase, class Access, bool Const>
+link_iterator<Owner, NodeBase, Access, Const>
+link_iterator<Owner, NodeBase, Access, Const>::operator++(int) {
+  link_iterator it = *this;
+  _current = _current->_next;
+  return it;
+}
+
+template <class Owner, class NodeBase, class Access, bool Const>
+typename link_iterator<Owner, NodeBase, Access, Const>::reference
+    link_iterator<Owner, NodeBase, Access, Const>::operator*() const {
+  return Access::value(_current);
+}
+
+template <class Owner, class NodeBase, class Access, bool Const>
+typename link_iterator<Owner, NodeBase, Access, Const>::pointer
+    link_iterator<Owner, NodeBase, Access, Const>::operator->() const {
+  return &Access::value(_current);
+}
+
+template <class Owner, class NodeBase, class Access, bool Const>
+link_iterator<Owner, NodeBase, Access, Const> &
+link_iterator<Owner, NodeBase, Access, Const>::operator--() {
+  _current = _current->_prev;
+  return *this;
+}
+
+template <class Owner, class NodeBase, class Access, bool Const>
+link_iterator<Owner, NodeBase, Access, Const>
+link_iterator<Owner, NodeBase, Access, Const>::operator--(int) {
+  link_iterator it = *this;
+  _current = _current->_prev;
+  return it;
+}
+
+template <class Owner, class NodeBase, class Access, bool Const>
+bool link_iterator<Owner, NodeBase, Access, Const>::operator==(
+    link_iterator other) const {
+  return _current == other._current;
+}
+
+template <class Owner, class NodeBase, class Access, bool Const>
+bool link_iterator<Owner, NodeBase, Access, Const>::operator!=(
+    link_iterator other) const {
+  return _current != other._current;
+}
+
+// Nothing to do when pos is an end of the range itself.
+template <class NodeBase>
+void transfer(NodeBase *pos, NodeBase *first, NodeBase *last) {
+  if (first == last || pos == first || pos == last)
+    return;
+
+  NodeBase *last_node = last->_prev;
+
+  first->_prev->_next = last;
+  last->_prev = first->_prev;
+
+  first->_prev = pos->_prev;
+  last_node->_next = pos;
+  pos->_prev->_next = first;
+  pos->_prev = last_node;
+}
+
+// Stable: on ties nodes of sentinel's list stay in front of those of other.
+template <class Access, class NodeBase, class Compare>
+void merge(NodeBase *sentinel, NodeBase *other, Compare &comp) {
+  NodeBase *temp = sentinel->_next;
+  NodeBase *node = other->_next;
+
+  while (node != other) {
+    while (temp != sentinel && !comp(Access::value(node), Access::value(temp)))
+      temp = temp->_next;
+
+    if (temp == sentinel) {
+      transfer(sentinel, node, other);
+      break;
+    }
+
+    NodeBase *run_end = node->_next;
+    while (run_end != other &&
+           comp(Access::value(run_end), Access::value(temp)))
+      run_end = run_end->_next;
+
+    transfer(temp, node, run_end);
+    node = run_end;
+  }
+}
+
+// Stable merge of two nullptr-terminated runs: on ties `first` wins.
+template <class Access, class NodeBase, class Compare>
+NodeBase *merge_runs(NodeBase *first, NodeBase *second, Compare &comp) {
+  NodeBase *merged = nullptr;
+  NodeBase **link = &merged;
+
+  while (first && second) {
+    if (comp(Access::value(second), Access::value(first))) {
+      *link = second;
+      second = second->_next;
+    } else {
+      *link = first;
+      first = first->_next;
+    }
+    link = &(*link)->_next;
+  }
+  *link = first ? first : second;
+
+  return merged;
+}
+
+// Bottom-up merge sort over the _next chain: runs[i] holds a sorted run of
+// 2^i nodes (or none), older than the runs below it. The _prev links are
+// rebuilt in a last pass.
+template <class Access, class NodeBase, class Compare>
+void sort(NodeBase *sentinel, Compare &comp) {
+  if (sentinel->_next == sentinel->_prev)
+    return;
+
+  const size_t MAX_RUNS = 64;
+  NodeBase *runs[MAX_RUNS] = {};
+  size_t used_runs = 0;
+
+  sentinel->_prev->_next = nullptr;
+  NodeBase *node = sentinel->_next;
+
+  while (node) {
+    NodeBase *carry = node;
+    node = node->_next;
+    carry->_next = nullptr;
+
+    size_t i = 0;
+    for (; i < used_runs && runs[i]; ++i) {
+      carry = merge_runs<Access>(runs[i], carry, comp);
+      runs[i] = nullptr;
+    }
+    runs[i] = carry;
+    used_runs = std::max(used_runs, i + 1);
+  }
+
+  NodeBase *sorted = nullptr;
+  for (size_t i = 0; i < used_runs; ++i) {
+    if (runs[i])
+      sorted = sorted ? merge_runs<Access>(runs[i], sorted, comp) : runs[i];
+  }
+
+  NodeBase *prev = sentinel;
+  for (NodeBase *current = sorted; current; current = current->_next) {
+    prev->_next = current;
+    current->_prev = prev;
+    prev = current;
+  }
+  prev->_next = sentinel;
+  sentinel->_prev = prev;
+}
+
+template <class NodeBase> void reverse(NodeBase *sentinel) {
+  NodeBase *current_ptr = sentinel;
+  do {
+    std::swap(current_ptr->_next, current_ptr->_prev);
+    current_ptr = current_ptr->_prev;
+  } while (current_ptr != sentinel);
+}
+
+template <class Iterator, class UnaryPredicate, class Erase>
+size_t remove_if(Iterator first, Iterator last, UnaryPredicate &pred,
+                 Erase erase) {
+  size_t removed = 0;
+  while (first != last) {
+    if (pred(*first)) {
+      first = erase(first);
+      removed++;
+    } else {
+      ++first;
+    }
+  }
+  return removed;
+}
+
+template <class Iterator, class BinaryPredicate, class Erase>
+void unique(Iterator first, Iterator last, BinaryPredicate &pred,
+            Erase erase) {
+  if (first == last)
+    return;
+
+  Iterator kept = first;
+  for (Iterator iter = std::next(kept); iter != last;) {
+    if (pred(*kept, *iter)) {
+      iter = erase(iter);
+    } else {
+      kept = iter;
+      ++iter;
+    }
+  }
+}
+
+} // namespace task::detail
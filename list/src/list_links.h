@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+
+#include <algorithm>
+#include <type_traits>
+
+// What task::list and task::intrusive_list have in common: both keep a
+// circular chain of NodeBase links closed by a sentinel, and differ only in
+// how an element is reached from its node and in what erasing it means.
+// Everything here touches the links alone; Access maps a node to its
+// element:
+//
+//   struct Access {
+//     using value_type = T;
+//     static T &value(NodeBase *node);
+//     static const T &value(const NodeBase *node);
+//   };
+namespace task::detail {
+
+// The iterators of both lists. Owner is the list, which reaches _current to
+// relink nodes and is the only one that can make an iterator from a node.
+template <class Owner, class NodeBase, class Access, bool Const>
+class link_iterator {
+  using node_pointer =
+      std::conditional_t<Const, const NodeBase *, NodeBase *>;
+
+public:
+  using difference_type = ptrdiff_t;
+  using value_type = typename Access::value_type;
+  using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+  using reference =
+      std::conditional_t<Const, const value_type &, value_type &>;
+  using iterator_category = std::bidirectional_iterator_tag;
+
+  link_iterator();
+  // iterator converts to const_iterator, not the other way round.
+  template <bool C = Const, class = std::enable_if_t<C>>
+  link_iterator(const link_iterator<Owner, NodeBase, Access, false> &other);
+
+  link_iterator &operator++();
+  link_iterator operator++(int);
+  reference operator*() const;
+  pointer operator->() const;
+  link_iterator &operator--();
+  link_iterator operator--(int);
+
+  bool operator==(link_iterator other) const;
+  bool operator!=(link_iterator other) const;
+
+private:
+  link_iterator(node_pointer p);
+  friend Owner;
+  friend class link_iterator<Owner, NodeBase, Access, !Const>;
+
+  node_pointer _current;
+};
+
+// Relinks [first, last) in front of pos; the nodes may come from any list.
+template <class NodeBase>
+void transfer(NodeBase *pos, NodeBase *first, NodeBase *last);
+
+// Moves every node of the list closed by other onto the list closed by
+// sentinel, keeping both sorted by comp.
+template <class Access, class NodeBase, class Compare>
+void merge(NodeBase *sentinel, NodeBase *other, Compare &comp);
+
+template <class Access, class NodeBase, class Compare>
+void sort(NodeBase *sentinel, Compare &comp);
+
+template <class NodeBase> void reverse(NodeBase *sentinel);
+
+// Walk [first, last) and hand the matching positions to erase, which
+// returns the position after the one it took.
+template <class Iterator, class UnaryPredicate, class Erase>
+size_t remove_if(Iterator first, Iterator last, UnaryPredicate &pred,
+                 Erase erase);
+template <class Iterator, class BinaryPredicate, class Erase>
+void unique(Iterator first, Iterator last, BinaryPredicate &pred, Erase erase);
+
+} // namespace task::detail
+
+#include "list_links.cpp"
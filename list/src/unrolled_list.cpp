@@ -0,0 +1,798 @@
+#include "unrolled_list.h"
+
+namespace task {
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::init() {
+  _size = 0;
+  _sentinel._next = _sentinel._prev = &_sentinel;
+  _sentinel._live = 1;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::relink_sentinel() {
+  if (_size == 0) {
+    init();
+    return;
+  }
+  _sentinel._next->_prev = &_sentinel;
+  _sentinel._prev->_next = &_sentinel;
+}
+
+// Takes over the nodes of other in O(1), leaving it empty. The allocators
+// must compare equal.
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::steal(unrolled_list &other) {
+  _sentinel = other._sentinel;
+  _size = other._size;
+  relink_sentinel();
+  other.init();
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+T *unrolled_list<T, Alloc, P, N>::slot(NodeBase *node, unsigned index) {
+  return reinterpret_cast<T *>(&static_cast<Node *>(node)->_slots[index]);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+const T *unrolled_list<T, Alloc, P, N>::slot(const NodeBase *node,
+                                              unsigned index) {
+  return reinterpret_cast<const T *>(
+      &static_cast<const Node *>(node)->_slots[index]);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unsigned unrolled_list<T, Alloc, P, N>::first_slot(Mask mask) {
+  return __builtin_ctzll(mask);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unsigned unrolled_list<T, Alloc, P, N>::last_slot(Mask mask) {
+  return 63 - __builtin_clzll(mask);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unsigned unrolled_list<T, Alloc, P, N>::slot_count(Mask mask) {
+  return __builtin_popcountll(mask);
+}
+
+// The slots in front of index.
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::Mask
+unrolled_list<T, Alloc, P, N>::below(unsigned index) {
+  return (Mask(1) << index) - 1;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::Node *
+unrolled_list<T, Alloc, P, N>::allocate_node() {
+  Node *node = node_traits::allocate(_allocator, 1);
+  node->_live = 0;
+  return node;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::deallocate_node(NodeBase *node) {
+  node_traits::deallocate(_allocator, static_cast<Node *>(node), 1);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::link_before(NodeBase *next,
+                                                 NodeBase *node) {
+  node->_next = next;
+  node->_prev = next->_prev;
+  next->_prev->_next = node;
+  next->_prev = node;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::unlink(NodeBase *node) {
+  node->_prev->_next = node->_next;
+  node->_next->_prev = node->_prev;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+template <class... Args>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::construct_in(NodeBase *node, unsigned index,
+                                            Args &&... args) {
+  node_traits::construct(_allocator, slot(node, index),
+                         std::forward<Args>(args)...);
+  node->_live |= Mask(1) << index;
+  _size++;
+  return {node, index};
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+template <class... Args>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::construct_in_new_node(NodeBase *next,
+                                                     unsigned index,
+                                                     Args &&... args) {
+  Node *node = allocate_node();
+  try {
+    construct_in(node, index, std::forward<Args>(args)...);
+  } catch (...) {
+    deallocate_node(node);
+    throw;
+  }
+  link_before(next, node);
+  return {node, index};
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::destroy_in(NodeBase *node,
+                                               unsigned index) {
+  node_traits::destroy(_allocator, slot(node, index));
+  node->_live &= ~(Mask(1) << index);
+  _size--;
+}
+
+// Moves one element to a free slot, possibly in another node. The size is
+// unchanged.
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::relocate(NodeBase *from,
+                                             unsigned from_index,
+                                             NodeBase *to, unsigned to_index) {
+  node_traits::construct(_allocator, slot(to, to_index),
+                         std::move(*slot(from, from_index)));
+  to->_live |= Mask(1) << to_index;
+  node_traits::destroy(_allocator, slot(from, from_index));
+  from->_live &= ~(Mask(1) << from_index);
+}
+
+// Moves the elements in mask to the same slots of another node.
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::move_slots(NodeBase *from, NodeBase *to,
+                                               Mask mask) {
+  for (; mask; mask &= mask - 1) {
+    const unsigned index = first_slot(mask);
+    relocate(from, index, to, index);
+  }
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N>::iterator::iterator()
+    : _node{nullptr}, _slot{0} {}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N>::iterator::iterator(NodeBase *node,
+                                                  unsigned slot)
+    : _node{node}, _slot{slot} {}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator &
+unrolled_list<T, Alloc, P, N>::iterator::operator++() {
+  const Mask later = (_node->_live >> _slot) >> 1;
+  if (later) {
+    _slot += 1 + first_slot(later);
+  } else {
+    _node = _node->_next;
+    _slot = first_slot(_node->_live);
+  }
+  return *this;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::iterator::operator++(int) {
+  iterator it = *this;
+  ++*this;
+  return it;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator::reference
+    unrolled_list<T, Alloc, P, N>::iterator::operator*() const {
+  return *slot(_node, _slot);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator::pointer
+    unrolled_list<T, Alloc, P, N>::iterator::operator->() const {
+  return slot(_node, _slot);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator &
+unrolled_list<T, Alloc, P, N>::iterator::operator--() {
+  const Mask earlier = _node->_live & below(_slot);
+  if (earlier) {
+    _slot = last_slot(earlier);
+  } else {
+    _node = _node->_prev;
+    _slot = last_slot(_node->_live);
+  }
+  return *this;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::iterator::operator--(int) {
+  iterator it = *this;
+  --*this;
+  return it;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+bool unrolled_list<T, Alloc, P, N>::iterator::operator==(
+    iterator other) const {
+  return _node == other._node && _slot == other._slot;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+bool unrolled_list<T, Alloc, P, N>::iterator::operator!=(
+    iterator other) const {
+  return !(*this == other);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N>::const_iterator::const_iterator()
+    : _node{nullptr}, _slot{0} {}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N>::const_iterator::const_iterator(
+    const iterator &other)
+    : _node{other._node}, _slot{other._slot} {}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N>::const_iterator::const_iterator(
+    const NodeBase *node, unsigned slot)
+    : _node{node}, _slot{slot} {}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::const_iterator &
+unrolled_list<T, Alloc, P, N>::const_iterator::operator++() {
+  const Mask later = (_node->_live >> _slot) >> 1;
+  if (later) {
+    _slot += 1 + first_slot(later);
+  } else {
+    _node = _node->_next;
+    _slot = first_slot(_node->_live);
+  }
+  return *this;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::const_iterator
+unrolled_list<T, Alloc, P, N>::const_iterator::operator++(int) {
+  const_iterator it = *this;
+  ++*this;
+  return it;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::const_iterator::reference
+    unrolled_list<T, Alloc, P, N>::const_iterator::operator*() const {
+  return *slot(_node, _slot);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::const_iterator::pointer
+    unrolled_list<T, Alloc, P, N>::const_iterator::operator->() const {
+  return slot(_node, _slot);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::const_iterator &
+unrolled_list<T, Alloc, P, N>::const_iterator::operator--() {
+  const Mask earlier = _node->_live & below(_slot);
+  if (earlier) {
+    _slot = last_slot(earlier);
+  } else {
+    _node = _node->_prev;
+    _slot = last_slot(_node->_live);
+  }
+  return *this;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::const_iterator
+unrolled_list<T, Alloc, P, N>::const_iterator::operator--(int) {
+  const_iterator it = *this;
+  --*this;
+  return it;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+bool unrolled_list<T, Alloc, P, N>::const_iterator::operator==(
+    const_iterator other) const {
+  return _node == other._node && _slot == other._slot;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+bool unrolled_list<T, Alloc, P, N>::const_iterator::operator!=(
+    const_iterator other) const {
+  return !(*this == other);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N>::unrolled_list() : unrolled_list(Alloc()) {}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N>::unrolled_list(const Alloc &alloc)
+    : _allocator(alloc) {
+  init();
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+template <class InputIt, class>
+unrolled_list<T, Alloc, P, N>::unrolled_list(InputIt first, InputIt last,
+                                             const Alloc &alloc)
+    : unrolled_list(alloc) {
+  for (; first != last; ++first)
+    emplace_back(*first);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N>::~unrolled_list() {
+  clear();
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N>::unrolled_list(const unrolled_list &other)
+    : unrolled_list(other.cbegin(), other.cend(),
+                    std::allocator_traits<Alloc>::
+                        select_on_container_copy_construction(
+                            other.get_allocator())) {}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N>::unrolled_list(unrolled_list &&other) noexcept
+    : _allocator(std::move(other._allocator)) {
+  steal(other);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N> &
+unrolled_list<T, Alloc, P, N>::operator=(const unrolled_list &other) {
+  if (this == &other)
+    return *this;
+
+  clear();
+  if (node_traits::propagate_on_container_copy_assignment::value)
+    _allocator = other._allocator;
+  for (const_iterator it = other.cbegin(); it != other.cend(); ++it)
+    emplace_back(*it);
+  return *this;
+}
+
+// Steals the nodes of other unless it uses an unequal allocator that does
+// not propagate; only then are the elements moved one by one.
+template <class T, class Alloc, unrolled_policy P, size_t N>
+unrolled_list<T, Alloc, P, N> &
+unrolled_list<T, Alloc, P, N>::operator=(unrolled_list &&other) noexcept(
+    node_traits::propagate_on_container_move_assignment::value ||
+    node_traits::is_always_equal::value) {
+  if (this == &other)
+    return *this;
+
+  clear();
+  if constexpr (node_traits::propagate_on_container_move_assignment::value) {
+    _allocator = std::move(other._allocator);
+    steal(other);
+  } else if constexpr (node_traits::is_always_equal::value) {
+    steal(other);
+  } else if (_allocator == other._allocator) {
+    steal(other);
+  } else {
+    for (iterator it = other.begin(); it != other.end(); ++it)
+      emplace_back(std::move(*it));
+    other.clear();
+  }
+  return *this;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+Alloc unrolled_list<T, Alloc, P, N>::get_allocator() const {
+  return _allocator;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+T &unrolled_list<T, Alloc, P, N>::front() {
+  return *begin();
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+const T &unrolled_list<T, Alloc, P, N>::front() const {
+  return *cbegin();
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+T &unrolled_list<T, Alloc, P, N>::back() {
+  return *slot(_sentinel._prev, last_slot(_sentinel._prev->_live));
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+const T &unrolled_list<T, Alloc, P, N>::back() const {
+  const NodeBase *last = _sentinel._prev;
+  return *slot(last, last_slot(last->_live));
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::begin() {
+  return {_sentinel._next, first_slot(_sentinel._next->_live)};
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::end() {
+  return {&_sentinel, 0};
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::const_iterator
+unrolled_list<T, Alloc, P, N>::cbegin() const {
+  return {_sentinel._next, first_slot(_sentinel._next->_live)};
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::const_iterator
+unrolled_list<T, Alloc, P, N>::cend() const {
+  return {&_sentinel, 0};
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::reverse_iterator
+unrolled_list<T, Alloc, P, N>::rbegin() {
+  return reverse_iterator(end());
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::reverse_iterator
+unrolled_list<T, Alloc, P, N>::rend() {
+  return reverse_iterator(begin());
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+bool unrolled_list<T, Alloc, P, N>::empty() const {
+  return _size == 0;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+size_t unrolled_list<T, Alloc, P, N>::size() const {
+  return _size;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::clear() {
+  NodeBase *node = _sentinel._next;
+  while (node != &_sentinel) {
+    NodeBase *next = node->_next;
+    for (Mask live = node->_live; live; live &= live - 1)
+      node_traits::destroy(_allocator, slot(node, first_slot(live)));
+    deallocate_node(node);
+    node = next;
+  }
+  init();
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::insert(const_iterator pos, const T &value) {
+  return emplace(pos, value);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::insert(const_iterator pos, T &&value) {
+  return emplace(pos, std::move(value));
+}
+
+// Each insert may shift the element at pos, so the next one goes in front
+// of the successor of the element just inserted, and the first inserted
+// element is found again by stepping back from the final pos.
+template <class T, class Alloc, unrolled_policy P, size_t N>
+template <class InputIt, class>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::insert(const_iterator pos, InputIt first,
+                                      InputIt last) {
+  size_t count = 0;
+  for (; first != last; ++first, count++)
+    pos = std::next(emplace(pos, *first));
+
+  iterator it{const_cast<NodeBase *>(pos._node), pos._slot};
+  return std::prev(it, count);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+template <class... Args>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::emplace(const_iterator pos, Args &&... args) {
+  NodeBase *node = const_cast<NodeBase *>(pos._node);
+  const unsigned index = pos._slot;
+  const Mask top = Mask(1) << (N - 1);
+
+  if (node == &_sentinel) {
+    NodeBase *last = _sentinel._prev;
+    if (last != &_sentinel && !(last->_live & top))
+      return construct_in(last, last_slot(last->_live) + 1,
+                          std::forward<Args>(args)...);
+    return construct_in_new_node(&_sentinel, 0, std::forward<Args>(args)...);
+  }
+
+  // A free slot right in front of pos.
+  if (index > 0 && !(node->_live & (Mask(1) << (index - 1))))
+    return construct_in(node, index - 1, std::forward<Args>(args)...);
+
+  // pos is in slot 0: append to the previous node, or start a new one
+  // filling from the top so that further inserts here find room.
+  if (index == 0) {
+    NodeBase *prev = node->_prev;
+    if (prev != &_sentinel && !(prev->_live & top))
+      return construct_in(prev, last_slot(prev->_live) + 1,
+                          std::forward<Args>(args)...);
+    return construct_in_new_node(node, N - 1, std::forward<Args>(args)...);
+  }
+
+  const Mask all = (N == 64) ? ~Mask(0) : (Mask(1) << N) - 1;
+  const Mask free = ~node->_live & all;
+
+  // Below, other elements of node are moved, and args may refer to one of
+  // them, so the new element is built before anything moves.
+
+  // Full: move the smaller side of pos to a new node, keeping slots. The
+  // new element goes into the new node first, next to where that side will
+  // land.
+  if (!free) {
+    if (index < N / 2) {
+      iterator it =
+          construct_in_new_node(node, index, std::forward<Args>(args)...);
+      move_slots(node, it._node, below(index));
+      return it;
+    }
+    iterator it = construct_in_new_node(node->_next, index - 1,
+                                        std::forward<Args>(args)...);
+    move_slots(node, it._node, node->_live & ~below(index));
+    return it;
+  }
+
+  // Shift towards the nearest free slot; every slot in between is used, so
+  // the new element waits outside the node, built through the allocator
+  // like every element, and is then relocated in.
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  T *value = reinterpret_cast<T *>(&storage);
+  node_traits::construct(_allocator, value, std::forward<Args>(args)...);
+
+  iterator it;
+  try {
+    const Mask free_below = free & below(index);
+    const Mask free_above = free & ~below(index);
+    if (free_below &&
+        (!free_above ||
+         index - last_slot(free_below) <= first_slot(free_above) - index)) {
+      for (unsigned i = last_slot(free_below) + 1; i < index; i++)
+        relocate(node, i, node, i - 1);
+      it = construct_in(node, index - 1, std::move(*value));
+    } else {
+      for (unsigned i = first_slot(free_above); i > index; i--)
+        relocate(node, i - 1, node, i);
+      it = construct_in(node, index, std::move(*value));
+    }
+  } catch (...) {
+    node_traits::destroy(_allocator, value);
+    throw;
+  }
+  node_traits::destroy(_allocator, value);
+  return it;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+template <class... Args>
+void unrolled_list<T, Alloc, P, N>::emplace_back(Args &&... args) {
+  emplace(cend(), std::forward<Args>(args)...);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+template <class... Args>
+void unrolled_list<T, Alloc, P, N>::emplace_front(Args &&... args) {
+  emplace(cbegin(), std::forward<Args>(args)...);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::erase(const_iterator pos) {
+  NodeBase *node = const_cast<NodeBase *>(pos._node);
+  const_iterator next = std::next(pos);
+
+  destroy_in(node, pos._slot);
+
+  if (!node->_live) {
+    unlink(node);
+    deallocate_node(node);
+  } else if (P == unrolled_policy::compact) {
+    return compact(node, next);
+  }
+  return {const_cast<NodeBase *>(next._node), next._slot};
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::erase(const_iterator first,
+                                     const_iterator last) {
+  // Count first: compaction may move the element last refers to.
+  size_t count = std::distance(first, last);
+  iterator it{const_cast<NodeBase *>(first._node), first._slot};
+  while (count-- > 0)
+    it = erase(it);
+  return it;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::push_back(const T &value) {
+  emplace_back(value);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::push_back(T &&value) {
+  emplace_back(std::move(value));
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::pop_back() {
+  erase(--cend());
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::push_front(const T &value) {
+  emplace_front(value);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::push_front(T &&value) {
+  emplace_front(std::move(value));
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::pop_front() {
+  erase(cbegin());
+}
+
+// Merges node with a neighbour when both fit in three quarters of a node,
+// leaving room for inserts, and returns where next ended up.
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::iterator
+unrolled_list<T, Alloc, P, N>::compact(NodeBase *node, const_iterator next) {
+  const unsigned limit = N * 3 / 4;
+  const unsigned count = slot_count(node->_live);
+
+  NodeBase *first = nullptr;
+  if (node->_next != &_sentinel &&
+      count + slot_count(node->_next->_live) <= limit) {
+    first = node;
+  } else if (node->_prev != &_sentinel &&
+             count + slot_count(node->_prev->_live) <= limit) {
+    first = node->_prev;
+  }
+  if (!first)
+    return {const_cast<NodeBase *>(next._node), next._slot};
+
+  NodeBase *second = first->_next;
+  const unsigned first_count = slot_count(first->_live);
+  if (next._node == first) {
+    next._slot = slot_count(first->_live & below(next._slot));
+  } else if (next._node == second) {
+    next._node = first;
+    next._slot = first_count + slot_count(second->_live & below(next._slot));
+  }
+
+  merge_nodes(first, second);
+  return {const_cast<NodeBase *>(next._node), next._slot};
+}
+
+// Packs the elements of first and then second into the low slots of first
+// and frees second.
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::merge_nodes(NodeBase *first,
+                                                NodeBase *second) {
+  unsigned target = 0;
+  for (Mask live = first->_live; live; live &= live - 1, target++) {
+    const unsigned index = first_slot(live);
+    if (index != target)
+      relocate(first, index, first, target);
+  }
+  for (Mask live = second->_live; live; live &= live - 1, target++)
+    relocate(second, first_slot(live), first, target);
+
+  unlink(second);
+  deallocate_node(second);
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::swap(unrolled_list &other) noexcept {
+  if constexpr (node_traits::propagate_on_container_swap::value) {
+    using std::swap;
+    swap(_allocator, other._allocator);
+  }
+  std::swap(_sentinel, other._sentinel);
+  std::swap(_size, other._size);
+
+  relink_sentinel();
+  other.relink_sentinel();
+}
+
+// Makes `at` the first element of its node by moving it and everything
+// after it in that node to a new node that follows. Returns the node that
+// now starts at `at`; the slots of the moved elements do not change.
+template <class T, class Alloc, unrolled_policy P, size_t N>
+typename unrolled_list<T, Alloc, P, N>::NodeBase *
+unrolled_list<T, Alloc, P, N>::split_at(const_iterator at) {
+  NodeBase *node = const_cast<NodeBase *>(at._node);
+  if (at._slot == first_slot(node->_live))
+    return node;
+
+  Node *fresh = allocate_node();
+  link_before(node->_next, fresh);
+  move_slots(node, fresh, node->_live & ~below(at._slot));
+  return fresh;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::splice(const_iterator pos,
+                                           unrolled_list &other) {
+  if (this == &other || other.empty())
+    return;
+
+  const size_t count = other._size;
+  NodeBase *next = split_at(pos);
+  NodeBase *first = other._sentinel._next;
+  NodeBase *last = other._sentinel._prev;
+  other.init();
+
+  first->_prev = next->_prev;
+  last->_next = next;
+  next->_prev->_next = first;
+  next->_prev = last;
+
+  _size += count;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void unrolled_list<T, Alloc, P, N>::splice(const_iterator pos,
+                                           unrolled_list &other,
+                                           const_iterator first,
+                                           const_iterator last) {
+  if (first == last || pos == first || pos == last)
+    return;
+
+  // Split from the back so that each split only moves elements behind the
+  // iterators still to be used, then point those iterators at the new node.
+  auto follow = [](const_iterator &it, const_iterator at, NodeBase *node) {
+    if (it._node == at._node && it._slot >= at._slot)
+      it._node = node;
+  };
+
+  NodeBase *last_node = other.split_at(last);
+  follow(first, last, last_node);
+  follow(pos, last, last_node);
+
+  NodeBase *first_node = other.split_at(first);
+  follow(pos, first, first_node);
+
+  NodeBase *next = split_at(pos);
+  NodeBase *back = last_node->_prev;
+
+  if (this != &other) {
+    size_t count = 0;
+    for (NodeBase *node = first_node; node != last_node; node = node->_next)
+      count += slot_count(node->_live);
+    _size += count;
+    other._size -= count;
+  }
+
+  first_node->_prev->_next = last_node;
+  last_node->_prev = first_node->_prev;
+
+  first_node->_prev = next->_prev;
+  back->_next = next;
+  next->_prev->_next = first_node;
+  next->_prev = back;
+}
+
+template <class T, class Alloc, unrolled_policy P, size_t N>
+void swap(unrolled_list<T, Alloc, P, N> &lhs,
+          unrolled_list<T, Alloc, P, N> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+} // namespace task
@@ -0,0 +1,247 @@
+#pragma once
+#include <cstdint>
+#include <iterator>
+#include <memory>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace task {
+
+// What unrolled_list may do to keep its nodes dense.
+enum class unrolled_policy {
+  // erase() merges a node with a neighbour once both fit in three quarters
+  // of a node, so iteration does not walk mostly empty nodes. Iterators to
+  // the elements of the merged nodes are invalidated.
+  compact,
+  // erase() never moves other elements, at the cost of sparse nodes after
+  // heavy erasure: erasing keeps every other iterator valid. Inserts and
+  // splices still shift or split the node they land in, as under compact.
+  stable,
+};
+
+// About 512 bytes of elements per node, but no more slots than the bits of
+// the occupancy mask.
+template <class T> constexpr size_t unrolled_capacity() {
+  return std::max<size_t>(4, std::min<size_t>(64, 512 / sizeof(T)));
+}
+
+// A list keeping up to Capacity elements in each node. Elements sit in slot
+// order inside a node, with an occupancy mask marking the used slots, so
+// pushes and pops at either end and erase() never shift other elements. An
+// insert in the middle of a node either shifts the elements between pos and
+// the nearest free slot of that node, or splits a full node in two; both
+// invalidate iterators into that node only. Iterators into other nodes are
+// never affected by an insert, nor by an erase under unrolled_policy::stable.
+template <class T, class Alloc = std::allocator<T>,
+          unrolled_policy Policy = unrolled_policy::compact,
+          size_t Capacity = unrolled_capacity<T>()>
+class unrolled_list {
+  static_assert(Capacity > 1 && Capacity <= 64,
+                "node occupancy is kept in a 64-bit mask");
+
+private:
+  using Mask = uint64_t;
+
+  struct NodeBase {
+    NodeBase *_next;
+    NodeBase *_prev;
+    Mask _live;
+  };
+
+  // Allocated raw: the links and mask are assigned and each slot is
+  // constructed through the allocator when it is filled.
+  struct Node : NodeBase {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type
+        _slots[Capacity];
+  };
+
+  using allocator_type_internal =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+  using node_traits = std::allocator_traits<allocator_type_internal>;
+  allocator_type_internal _allocator;
+
+  // Circular like task::list. Its mask has slot 0 set, so stepping onto the
+  // sentinel lands on {&_sentinel, 0}, which is end().
+  NodeBase _sentinel;
+  size_t _size;
+
+public:
+  class iterator {
+  public:
+    using difference_type = ptrdiff_t;
+    using value_type = T;
+    using pointer = T *;
+    using reference = T &;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+    iterator();
+
+    iterator &operator++();
+    iterator operator++(int);
+    reference operator*() const;
+    pointer operator->() const;
+    iterator &operator--();
+    iterator operator--(int);
+
+    bool operator==(iterator other) const;
+    bool operator!=(iterator other) const;
+
+  protected:
+    iterator(NodeBase *node, unsigned slot);
+    friend class unrolled_list;
+
+  private:
+    NodeBase *_node;
+    unsigned _slot;
+  };
+
+  class const_iterator {
+  public:
+    using difference_type = ptrdiff_t;
+    using value_type = T;
+    using pointer = const T *;
+    using reference = const T &;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+    const_iterator();
+    const_iterator(const iterator &);
+
+    const_iterator &operator++();
+    const_iterator operator++(int);
+    reference operator*() const;
+    pointer operator->() const;
+    const_iterator &operator--();
+    const_iterator operator--(int);
+
+    bool operator==(const_iterator other) const;
+    bool operator!=(const_iterator other) const;
+
+  protected:
+    const_iterator(const NodeBase *node, unsigned slot);
+    friend class unrolled_list;
+
+  private:
+    const NodeBase *_node;
+    unsigned _slot;
+  };
+
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  template <class InputIt>
+  using RequireInputIterator = std::enable_if_t<std::is_convertible<
+      typename std::iterator_traits<InputIt>::iterator_category,
+      std::input_iterator_tag>::value>;
+
+public:
+  unrolled_list();
+  explicit unrolled_list(const Alloc &alloc);
+  template <class InputIt, class = RequireInputIterator<InputIt>>
+  unrolled_list(InputIt first, InputIt last, const Alloc &alloc = Alloc());
+
+  ~unrolled_list();
+
+  unrolled_list(const unrolled_list &other);
+  unrolled_list(unrolled_list &&other) noexcept;
+  unrolled_list &operator=(const unrolled_list &other);
+  unrolled_list &operator=(unrolled_list &&other) noexcept(
+      node_traits::propagate_on_container_move_assignment::value ||
+      node_traits::is_always_equal::value);
+
+  Alloc get_allocator() const;
+
+  T &front();
+  const T &front() const;
+
+  T &back();
+  const T &back() const;
+
+  iterator begin();
+  iterator end();
+
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+
+  reverse_iterator rbegin();
+  reverse_iterator rend();
+
+  bool empty() const;
+  size_t size() const;
+  void clear();
+
+  iterator insert(const_iterator pos, const T &value);
+  iterator insert(const_iterator pos, T &&value);
+  template <class InputIt, class = RequireInputIterator<InputIt>>
+  iterator insert(const_iterator pos, InputIt first, InputIt last);
+
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last);
+
+  void push_back(const T &value);
+  void push_back(T &&value);
+  void pop_back();
+
+  void push_front(const T &value);
+  void push_front(T &&value);
+  void pop_front();
+
+  template <class... Args>
+  iterator emplace(const_iterator pos, Args &&... args);
+
+  template <class... Args> void emplace_back(Args &&... args);
+
+  template <class... Args> void emplace_front(Args &&... args);
+
+  void swap(unrolled_list &other) noexcept;
+
+  // Whole nodes are relinked; at most the nodes holding pos, first and last
+  // are split, so the cost does not depend on the length of either list.
+  // Iterators to elements that share a node with pos, first or last behind
+  // the split point are invalidated.
+  void splice(const_iterator pos, unrolled_list &other);
+  // Also walks the moved nodes once to count their elements.
+  void splice(const_iterator pos, unrolled_list &other, const_iterator first,
+              const_iterator last);
+
+private:
+  void init();
+  void relink_sentinel();
+  void steal(unrolled_list &other);
+
+  static T *slot(NodeBase *node, unsigned index);
+  static const T *slot(const NodeBase *node, unsigned index);
+
+  static unsigned first_slot(Mask mask);
+  static unsigned last_slot(Mask mask);
+  static unsigned slot_count(Mask mask);
+  static Mask below(unsigned index);
+
+  Node *allocate_node();
+  void deallocate_node(NodeBase *node);
+  static void link_before(NodeBase *next, NodeBase *node);
+  static void unlink(NodeBase *node);
+
+  template <class... Args>
+  iterator construct_in(NodeBase *node, unsigned index, Args &&... args);
+  template <class... Args>
+  iterator construct_in_new_node(NodeBase *next, unsigned index,
+                                 Args &&... args);
+  void destroy_in(NodeBase *node, unsigned index);
+  void relocate(NodeBase *from, unsigned from_index, NodeBase *to,
+                unsigned to_index);
+  void move_slots(NodeBase *from, NodeBase *to, Mask mask);
+
+  NodeBase *split_at(const_iterator at);
+  iterator compact(NodeBase *node, const_iterator next);
+  void merge_nodes(NodeBase *first, NodeBase *second);
+};
+
+template <class T, class Alloc, unrolled_policy Policy, size_t Capacity>
+void swap(unrolled_list<T, Alloc, Policy, Capacity> &lhs,
+          unrolled_list<T, Alloc, Policy, Capacity> &rhs) noexcept;
+
+} // namespace task
+
+#include "unrolled_list.cpp"
@@ -4,7 +4,12 @@
 #include <algorithm>
 #include <vector>
 #include <list>
+#include <stdexcept>
+#include <thread>
+#include "src/concurrent_queue.h"
+#include "src/intrusive_list.h"
 #include "src/list.h"
+#include "src/unrolled_list.h"
 
 
 size_t RandomUInt(size_t max = -1) {
@@ -53,6 +58,25 @@ struct MoveTester {
   MoveTester& operator=(MoveTester&&) noexcept { action = "MA"; return *this; }
 };
 
+// Counts live instances; assigning from a poisoned one throws.
+struct ThrowingAssign {
+  static size_t live;
+  bool poisoned = false;
+
+  explicit ThrowingAssign(bool p = false) : poisoned(p) { ++live; }
+  ThrowingAssign(const ThrowingAssign& other) : poisoned(other.poisoned) { ++live; }
+  ~ThrowingAssign() { --live; }
+
+  ThrowingAssign& operator=(const ThrowingAssign& other) {
+    if (other.poisoned) {
+      throw std::runtime_error("poisoned");
+    }
+    return *this;
+  }
+};
+
+size_t ThrowingAssign::live = 0;
+
 struct ArgForwardTester {
   std::string actions;
 
@@ -62,6 +86,45 @@ struct ArgForwardTester {
 };
 
 
+size_t allocations_count = 0;
+
+template <class T>
+struct CountingAllocator : std::allocator<T> {
+  template <class U> struct rebind { using other = CountingAllocator<U>; };
+
+  CountingAllocator() = default;
+  template <class U>
+  CountingAllocator(const CountingAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    ++allocations_count;
+    return std::allocator<T>::allocate(n);
+  }
+};
+
+
+// Allocators with different ids do not compare equal and, like
+// std::pmr::polymorphic_allocator, are not propagated on move assignment
+// and cannot be default-constructed.
+template <class T>
+struct IdAllocator : std::allocator<T> {
+  template <class U> struct rebind { using other = IdAllocator<U>; };
+  using propagate_on_container_move_assignment = std::false_type;
+  using is_always_equal = std::false_type;
+
+  int id = 0;
+
+  explicit IdAllocator(int i) : id(i) {}
+  template <class U>
+  IdAllocator(const IdAllocator<U>& other) : id(other.id) {}
+
+  template <class U>
+  bool operator==(const IdAllocator<U>& other) const { return id == other.id; }
+  template <class U>
+  bool operator!=(const IdAllocator<U>& other) const { return id != other.id; }
+};
+
+
 void FailWithMsg(const std::string& msg, int line) {
   std::cerr << "Test failed!\n";
   std::cerr << "[Line " << line << "] "  << msg << std::endl;
@@ -78,6 +141,124 @@ void FailWithMsg(const std::string& msg, int line) {
     ASSERT_TRUE_MSG(std::equal(cont1.begin(), cont1.end(), cont2.begin(), cont2.end()), msg)
 
 
+struct ByKey {};
+
+// On two lists at once: through its base hook and through ready_hook.
+struct Job : task::list_hook<ByKey> {
+  size_t key;
+  size_t id;
+  task::list_hook<> ready_hook;
+
+  Job(size_t k, size_t i) : key(k), id(i) {}
+
+  bool operator==(const Job& other) const { return key == other.key; }
+};
+
+bool operator<(const Job& a, const Job& b) { return a.key < b.key; }
+
+// The hook lives in a base that does not start the object.
+struct Payload {
+  size_t value;
+};
+
+struct Linked {
+  task::list_hook<> hook;
+};
+
+struct Entry : Payload, Linked {
+  explicit Entry(size_t v) : Payload{v} {}
+};
+
+
+template <class List>
+void UnrolledStressTest() {
+  List list_task;
+  std::list<size_t> list_std;
+
+  for (size_t step = 0; step < 4000; ++step) {
+    const size_t position = RandomUInt(list_std.size());
+    auto it_task = std::next(list_task.begin(), position);
+    auto it_std = std::next(list_std.begin(), position);
+
+    switch (RandomUInt(6)) {
+    case 0:
+    case 1: {
+      const size_t value = RandomUInt(1000);
+      it_task = list_task.insert(it_task, value);
+      it_std = list_std.insert(it_std, value);
+      ASSERT_TRUE_MSG(*it_task == *it_std, "unrolled_list::insert result")
+      break;
+    }
+    case 2:
+      if (it_std != list_std.end()) {
+        it_task = list_task.erase(it_task);
+        it_std = list_std.erase(it_std);
+        ASSERT_TRUE_MSG((it_task == list_task.end()) == (it_std == list_std.end()),
+                        "unrolled_list::erase result")
+      }
+      break;
+    case 3: {
+      const size_t value = RandomUInt(1000);
+      if (TossCoin()) {
+        list_task.push_back(value);
+        list_std.push_back(value);
+      } else {
+        list_task.push_front(value);
+        list_std.push_front(value);
+      }
+      break;
+    }
+    case 4: {
+      List other_task;
+      std::list<size_t> other_std;
+      RandomFill(other_std, RandomUInt(10), 1000);
+      for (auto value : other_std) {
+        other_task.push_back(value);
+      }
+      const size_t from = RandomUInt(other_std.size());
+      const size_t to = from + RandomUInt(other_std.size() - from);
+      list_task.splice(it_task, other_task, std::next(other_task.cbegin(), from),
+                       std::next(other_task.cbegin(), to));
+      list_std.splice(it_std, other_std, std::next(other_std.cbegin(), from),
+                      std::next(other_std.cbegin(), to));
+      ASSERT_TRUE_MSG(other_task.size() == other_std.size(), "unrolled_list::splice size")
+      ASSERT_EQUAL_MSG(other_task, other_std, "unrolled_list::splice source")
+      list_task.splice(list_task.cbegin(), other_task);
+      list_std.splice(list_std.cbegin(), other_std);
+      break;
+    }
+    case 5:
+      if (list_std.size() > 1) {
+        const size_t from = RandomUInt(list_std.size() - 1);
+        const size_t to = from + RandomUInt(list_std.size() - from);
+        const size_t dest = (from > 0 && TossCoin()) ? RandomUInt(from - 1) : to + RandomUInt(list_std.size() - to);
+        list_task.splice(std::next(list_task.cbegin(), dest), list_task,
+                         std::next(list_task.cbegin(), from), std::next(list_task.cbegin(), to));
+        list_std.splice(std::next(list_std.cbegin(), dest), list_std,
+                        std::next(list_std.cbegin(), from), std::next(list_std.cbegin(), to));
+      }
+      break;
+    case 6:
+      if (!list_std.empty()) {
+        // The value is an element next to pos, likely in the node that
+        // the insert shifts or splits.
+        const size_t source = (position > 0 && TossCoin()) ? position - 1
+                                                            : std::min(position, list_std.size() - 1);
+        it_task = list_task.insert(it_task, *std::next(list_task.begin(), source));
+        it_std = list_std.insert(it_std, *std::next(list_std.begin(), source));
+        ASSERT_TRUE_MSG(*it_task == *it_std, "unrolled_list::insert of an element of the list")
+      }
+      break;
+    }
+
+    ASSERT_TRUE_MSG(list_task.size() == list_std.size(), "unrolled_list::size")
+    ASSERT_EQUAL_MSG(list_task, list_std, "unrolled_list stress test")
+    ASSERT_TRUE_MSG(std::equal(list_task.rbegin(), list_task.rend(), list_std.rbegin(), list_std.rend()),
+                    "unrolled_list reverse iteration")
+  }
+}
+
+
 int main() {
 
   {
@@ -242,7 +423,8 @@ int main() {
       ASSERT_EQUAL_MSG(list_task2, list_std2, "move operator=")
     }
 
-    list_task.remove(list_task.front());
+    const size_t front_count = std::count(list_std.begin(), list_std.end(), list_std.front());
+    ASSERT_TRUE_MSG(list_task.remove(list_task.front()) == front_count, "list::remove count")
     list_std.remove(list_std.front());
 
     ASSERT_EQUAL_MSG(list_task, list_std, "list::remove")
@@ -272,6 +454,462 @@ int main() {
     }
   }
 
+  {
+    using Item = std::pair<size_t, size_t>;
+    auto by_key = [](const Item& lhs, const Item& rhs) { return lhs.first < rhs.first; };
+
+    task::list<Item> list_task;
+    std::vector<Item> items;
+    for (size_t i = 0, count = RandomUInt(1000, 5000); i < count; ++i) {
+      items.emplace_back(RandomUInt(50), i);
+      list_task.push_back(items.back());
+    }
+    const Item* first_address = &list_task.front();
+    const Item first_item = list_task.front();
+
+    list_task.sort(by_key);
+    std::stable_sort(items.begin(), items.end(), by_key);
+
+    ASSERT_EQUAL_MSG(list_task, items, "list::sort(Compare) stability")
+    ASSERT_TRUE_MSG(*first_address == first_item, "list::sort relinks nodes")
+  }
+
+  {
+    using Item = std::pair<size_t, size_t>;
+    auto by_key = [](const Item& lhs, const Item& rhs) { return lhs.first < rhs.first; };
+
+    task::list<Item> list_task, list_task2;
+    std::list<Item> list_std, list_std2;
+    for (size_t i = 0; i < 200; ++i) {
+      Item item{RandomUInt(20), i};
+      if (TossCoin()) {
+        list_task.push_back(item);
+        list_std.push_back(item);
+      } else {
+        list_task2.push_back(item);
+        list_std2.push_back(item);
+      }
+    }
+    list_task.sort(by_key);
+    list_task2.sort(by_key);
+    list_std.sort(by_key);
+    list_std2.sort(by_key);
+
+    list_task.merge(list_task2, by_key);
+    list_std.merge(list_std2, by_key);
+    ASSERT_EQUAL_MSG(list_task, list_std, "list::merge(Compare) stability")
+    ASSERT_TRUE_MSG(list_task2.empty() && list_task.size() == 200, "list::merge(Compare)")
+
+    list_task2.splice(list_task2.cend(), list_task, std::next(list_task.cbegin(), 10));
+    list_std2.splice(list_std2.cend(), list_std, std::next(list_std.cbegin(), 10));
+    list_task2.splice(list_task2.cbegin(), list_task, std::next(list_task.cbegin(), 20),
+                      std::next(list_task.cbegin(), 50));
+    list_std2.splice(list_std2.cbegin(), list_std, std::next(list_std.cbegin(), 20),
+                     std::next(list_std.cbegin(), 50));
+    list_task.splice(list_task.cbegin(), list_task2, list_task2.cbegin(),
+                     std::next(list_task2.cbegin(), 5), 5);
+    list_std.splice(list_std.cbegin(), list_std2, list_std2.cbegin(),
+                    std::next(list_std2.cbegin(), 5));
+    list_task.splice(list_task.cend(), list_task, list_task.cbegin(), std::next(list_task.cbegin(), 3));
+    list_std.splice(list_std.cend(), list_std, list_std.cbegin(), std::next(list_std.cbegin(), 3));
+    ASSERT_EQUAL_MSG(list_task, list_std, "list::splice range")
+    ASSERT_EQUAL_MSG(list_task2, list_std2, "list::splice range")
+    ASSERT_TRUE_MSG(list_task.size() == list_std.size() && list_task2.size() == list_std2.size(),
+                    "list::splice size")
+
+    auto odd_id = [](const Item& item) { return item.second % 2 == 1; };
+    const size_t odd_count = std::count_if(list_std.begin(), list_std.end(), odd_id);
+    ASSERT_TRUE_MSG(list_task.remove_if(odd_id) == odd_count, "list::remove_if count")
+    list_std.remove_if(odd_id);
+    ASSERT_EQUAL_MSG(list_task, list_std, "list::remove_if")
+
+    auto same_key = [](const Item& lhs, const Item& rhs) { return lhs.first == rhs.first; };
+    list_task.unique(same_key);
+    list_std.unique(same_key);
+    ASSERT_EQUAL_MSG(list_task, list_std, "list::unique(BinaryPredicate)")
+  }
+
+  {
+    task::list<size_t, CountingAllocator<size_t>> list;
+    std::list<size_t> list_std;
+    for (size_t i = 0; i < 100; ++i) {
+      list.push_back(i);
+      list_std.push_back(i);
+    }
+    const size_t allocations_before = allocations_count;
+    for (size_t i = 0; i < 10000; ++i) {
+      list.pop_front();
+      list.push_back(i);
+      list_std.pop_front();
+      list_std.push_back(i);
+    }
+    ASSERT_TRUE_MSG(allocations_count == allocations_before, "node recycling")
+    ASSERT_EQUAL_MSG(list, list_std, "node recycling")
+
+    list.clear();
+    list.shrink_to_fit();
+    list.push_back(1);
+    ASSERT_TRUE_MSG(allocations_count == allocations_before + 1, "list::shrink_to_fit")
+  }
+
+  {
+    UnrolledStressTest<task::unrolled_list<size_t>>();
+    UnrolledStressTest<task::unrolled_list<size_t, std::allocator<size_t>, task::unrolled_policy::compact, 4>>();
+    UnrolledStressTest<task::unrolled_list<size_t, std::allocator<size_t>, task::unrolled_policy::stable, 4>>();
+    UnrolledStressTest<task::unrolled_list<size_t, std::allocator<size_t>, task::unrolled_policy::stable, 64>>();
+
+    task::unrolled_list<std::string> strings;
+    strings.emplace_back(3, 'a');
+    strings.emplace_front("b");
+    task::unrolled_list<std::string> copy = strings;
+    task::unrolled_list<std::string> moved = std::move(strings);
+    ASSERT_TRUE_MSG(strings.empty() && copy.size() == 2 && moved.front() == "b" && moved.back() == "aaa",
+                    "unrolled_list copy and move")
+
+    // Inserting a copy of an element of the node that has to make room.
+    task::unrolled_list<std::string, std::allocator<std::string>, task::unrolled_policy::compact, 4> full;
+    for (const char* word : {"zero", "one", "two", "three"}) {
+      full.push_back(word);
+    }
+    full.pop_back();
+    full.insert(std::next(full.begin()), *std::next(full.begin()));
+    const std::vector<std::string> shifted = {"zero", "one", "one", "two"};
+    ASSERT_EQUAL_MSG(full, shifted, "unrolled_list::insert of an element it shifts")
+    full.insert(std::next(full.begin(), 3), *std::next(full.begin(), 3));
+    const std::vector<std::string> split = {"zero", "one", "one", "two", "two"};
+    ASSERT_EQUAL_MSG(full, split, "unrolled_list::insert of an element of a full node")
+  }
+
+  {
+    // Stable erase: iterators to surviving elements keep pointing at them.
+    using Stable = task::unrolled_list<size_t, std::allocator<size_t>, task::unrolled_policy::stable, 8>;
+    Stable list;
+    std::vector<Stable::iterator> iterators;
+    for (size_t i = 0; i < 200; ++i) {
+      list.push_back(i);
+      iterators.push_back(std::prev(list.end()));
+    }
+    std::vector<size_t> kept;
+    for (size_t i = 0; i < 200; ++i) {
+      if (TossCoin()) {
+        list.erase(iterators[i]);
+      } else {
+        kept.push_back(i);
+      }
+    }
+    bool stable = true;
+    for (size_t i : kept) {
+      stable = stable && *iterators[i] == i;
+    }
+    ASSERT_TRUE_MSG(stable, "unrolled_policy::stable keeps iterators valid across erase")
+    ASSERT_EQUAL_MSG(list, kept, "unrolled_policy::stable erase")
+  }
+
+  {
+    static_assert(std::is_nothrow_move_constructible<task::list<std::string>>::value, "");
+    static_assert(std::is_nothrow_move_assignable<task::list<std::string>>::value, "");
+    static_assert(!std::is_nothrow_move_assignable<task::list<int, IdAllocator<int>>>::value, "");
+
+    // Reallocation moves the lists, so their nodes stay where they were.
+    std::vector<task::list<std::string>> lists(1);
+    lists[0].push_back("first");
+    const std::string* first = &lists[0].front();
+    for (size_t i = 0; i < 100; ++i) {
+      lists.emplace_back(3, "x");
+    }
+    ASSERT_TRUE_MSG(&lists[0].front() == first, "std::vector<task::list> reallocation moves")
+
+    using std::swap;
+    swap(lists[0], lists[1]);
+    ASSERT_TRUE_MSG(&lists[1].front() == first && lists[0].size() == 3, "swap(list, list)")
+
+    task::list<int, IdAllocator<int>> left(IdAllocator<int>(1));
+    task::list<int, IdAllocator<int>> right(IdAllocator<int>(2));
+    task::list<int, IdAllocator<int>> same(IdAllocator<int>(2));
+    for (int i = 0; i < 10; ++i) {
+      right.push_back(i);
+      same.push_back(-i);
+    }
+    const int* right_front = &right.front();
+    left = std::move(right);
+    ASSERT_TRUE_MSG(left.get_allocator().id == 1 && left.size() == 10 && &left.front() != right_front && right.empty(),
+                    "move assignment with an unequal, non-propagating allocator moves elements")
+    const int* same_front = &same.front();
+    right = std::move(same);
+    ASSERT_TRUE_MSG(&right.front() == same_front && right.size() == 10, "move assignment with an equal allocator steals nodes")
+  }
+
+  {
+    static_assert(std::is_nothrow_move_constructible<task::unrolled_list<std::string>>::value, "");
+    static_assert(std::is_nothrow_move_assignable<task::unrolled_list<std::string>>::value, "");
+    static_assert(!std::is_nothrow_move_assignable<task::unrolled_list<int, IdAllocator<int>>>::value, "");
+
+    task::unrolled_list<int, IdAllocator<int>> left(IdAllocator<int>(1));
+    task::unrolled_list<int, IdAllocator<int>> right(IdAllocator<int>(2));
+    task::unrolled_list<int, IdAllocator<int>> same(IdAllocator<int>(2));
+    for (int i = 0; i < 100; ++i) {
+      right.push_back(i);
+      same.push_back(-i);
+    }
+    const int* right_front = &right.front();
+    left = std::move(right);
+    ASSERT_TRUE_MSG(left.get_allocator().id == 1 && left.size() == 100 && &left.front() != right_front && right.empty(),
+                    "unrolled_list move assignment with an unequal, non-propagating allocator moves elements")
+    const int* same_front = &same.front();
+    right = std::move(same);
+    ASSERT_TRUE_MSG(&right.front() == same_front && right.size() == 100 && same.empty(),
+                    "unrolled_list move assignment with an equal allocator steals nodes")
+  }
+
+  {
+    std::vector<Job> jobs;
+    for (size_t i = 0, count = RandomUInt(500, 1000); i < count; ++i) {
+      jobs.emplace_back(RandomUInt(50), i);
+    }
+
+    task::intrusive_list<Job, task::base_hook<ByKey>> by_key;
+    task::intrusive_list<Job, task::member_hook<&Job::ready_hook>> ready;
+    std::list<std::pair<size_t, size_t>> by_key_std;
+    for (auto& job : jobs) {
+      by_key.push_back(job);
+      by_key_std.emplace_back(job.key, job.id);
+      if (job.id % 2 == 0) {
+        ready.push_front(job);
+      }
+    }
+    auto same = [](const auto& list_task, const auto& list_std) {
+      return std::equal(list_task.cbegin(), list_task.cend(), list_std.begin(), list_std.end(),
+                        [](const Job& job, const std::pair<size_t, size_t>& item) {
+                          return job.key == item.first && job.id == item.second;
+                        });
+    };
+
+    by_key.sort();
+    by_key_std.sort([](const auto& a, const auto& b) { return a.first < b.first; });
+    ASSERT_TRUE_MSG(same(by_key, by_key_std), "intrusive_list::sort is stable")
+    ASSERT_TRUE_MSG(ready.size() == (jobs.size() + 1) / 2 && ready.front().id == (jobs.size() - 1) / 2 * 2,
+                    "sorting one list leaves the other alone")
+
+    task::intrusive_list<Job, task::base_hook<ByKey>> high;
+    std::list<std::pair<size_t, size_t>> high_std;
+    auto high_first = std::find_if(by_key.cbegin(), by_key.cend(), [](const Job& job) { return job.key >= 25; });
+    auto high_first_std = std::find_if(by_key_std.cbegin(), by_key_std.cend(),
+                                       [](const auto& item) { return item.first >= 25; });
+    high.splice(high.cend(), by_key, high_first, by_key.cend());
+    high_std.splice(high_std.cend(), by_key_std, high_first_std, by_key_std.cend());
+    ASSERT_TRUE_MSG(same(by_key, by_key_std) && same(high, high_std), "intrusive_list::splice")
+    ASSERT_TRUE_MSG(by_key.size() == by_key_std.size() && high.size() == high_std.size(),
+                    "intrusive_list::splice size")
+
+    high.merge(by_key);
+    high_std.merge(by_key_std, [](const auto& a, const auto& b) { return a.first < b.first; });
+    ASSERT_TRUE_MSG(same(high, high_std) && by_key.empty(), "intrusive_list::merge")
+
+    Job& some_job = jobs[jobs.size() / 2];
+    high.erase(high.iterator_to(some_job));
+    ASSERT_TRUE_MSG(!static_cast<task::list_hook<ByKey>&>(some_job).is_linked() &&
+                    (some_job.id % 2 != 0 || some_job.ready_hook.is_linked()),
+                    "intrusive_list::erase unlinks only that hook")
+
+    Job& linked_job = high.front();
+    Job copy = linked_job;
+    ASSERT_TRUE_MSG(!static_cast<task::list_hook<ByKey>&>(copy).is_linked() && !copy.ready_hook.is_linked(),
+                    "a copy of a linked element is not linked")
+    const size_t high_size = high.size();
+    linked_job = copy;
+    ASSERT_TRUE_MSG(&high.front() == &linked_job && high.size() == high_size &&
+                    std::distance(high.cbegin(), high.cend()) == static_cast<ptrdiff_t>(high_size),
+                    "assigning to a linked element keeps its links")
+
+    const size_t removed = high.remove_if([](const Job& job) { return job.key % 3 == 0; });
+    high.unique();
+    ASSERT_TRUE_MSG(removed > 0 && std::adjacent_find(high.cbegin(), high.cend()) == high.cend(),
+                    "intrusive_list::remove_if / unique")
+
+    ready.clear();
+    bool unlinked = true;
+    for (auto& job : jobs) {
+      unlinked = unlinked && !job.ready_hook.is_linked();
+    }
+    ASSERT_TRUE_MSG(unlinked, "intrusive_list::clear unlinks every element")
+  }
+
+  {
+    std::vector<Entry> entries = {Entry(1), Entry(2)};
+    task::intrusive_list<Entry, task::member_hook<&Entry::hook>> list;
+    for (auto& entry : entries) {
+      list.push_back(entry);
+    }
+    ASSERT_TRUE_MSG(&list.front() == &entries[0] && list.front().value == 1 && list.back().value == 2,
+                    "member_hook in a base that is not the first one")
+  }
+
+  {
+    task::concurrent_queue<std::string> queue;
+    ASSERT_TRUE_MSG(queue.empty(), "concurrent_queue starts empty")
+    queue.push_back("a");
+    queue.emplace_back(2, 'b');
+    queue.push_back("left in the queue");
+    std::string front;
+    ASSERT_TRUE_MSG(queue.try_pop(front) && front == "a", "concurrent_queue::try_pop")
+    ASSERT_TRUE_MSG(queue.pop_front() == "bb", "concurrent_queue::pop_front")
+    ASSERT_TRUE_MSG(!queue.empty(), "concurrent_queue::empty")
+  }
+
+  {
+    task::concurrent_queue<ThrowingAssign> queue;
+    queue.emplace_back(true);
+    queue.emplace_back(false);
+    ThrowingAssign target;
+    bool thrown = false;
+    try {
+      queue.try_pop(target);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    ASSERT_TRUE_MSG(thrown && ThrowingAssign::live == 2, "concurrent_queue::try_pop destroys a value it could not move")
+    ASSERT_TRUE_MSG(queue.try_pop(target) && !target.poisoned && queue.empty(),
+                    "concurrent_queue works after a throwing pop")
+  }
+
+  {
+    // Every element is popped exactly once, and each consumer sees the
+    // elements of any one producer in the order they were pushed.
+    const size_t PRODUCERS = 4;
+    const size_t CONSUMERS = 4;
+    const size_t PER_PRODUCER = 20000;
+
+    task::concurrent_queue<std::pair<size_t, size_t>> queue;
+    std::vector<std::vector<size_t>> popped(CONSUMERS);
+    std::vector<char> in_order(CONSUMERS, true);
+    std::atomic<size_t> remaining{PRODUCERS * PER_PRODUCER};
+
+    std::vector<std::thread> threads;
+    for (size_t producer = 0; producer < PRODUCERS; ++producer) {
+      threads.emplace_back([&queue, producer, PER_PRODUCER] {
+        for (size_t i = 0; i < PER_PRODUCER; ++i) {
+          queue.push_back({producer, i});
+        }
+      });
+    }
+    for (size_t consumer = 0; consumer < CONSUMERS; ++consumer) {
+      threads.emplace_back([&, consumer] {
+        std::vector<size_t> last(PRODUCERS, 0);
+        std::pair<size_t, size_t> item;
+        while (remaining.load() > 0) {
+          if (!queue.try_pop(item)) {
+            continue;
+          }
+          remaining--;
+          if (item.second + 1 <= last[item.first]) {
+            in_order[consumer] = false;
+          }
+          last[item.first] = item.second + 1;
+          popped[consumer].push_back(item.first * PER_PRODUCER + item.second);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    std::vector<size_t> all;
+    for (size_t consumer = 0; consumer < CONSUMERS; ++consumer) {
+      ASSERT_TRUE_MSG(in_order[consumer], "concurrent_queue keeps per-producer FIFO order")
+      all.insert(all.end(), popped[consumer].begin(), popped[consumer].end());
+    }
+    std::sort(all.begin(), all.end());
+    bool exactly_once = all.size() == PRODUCERS * PER_PRODUCER;
+    for (size_t i = 0; exactly_once && i < all.size(); ++i) {
+      exactly_once = all[i] == i;
+    }
+    ASSERT_TRUE_MSG(exactly_once, "concurrent_queue pops every element exactly once")
+    ASSERT_TRUE_MSG(queue.empty(), "concurrent_queue drained")
+  }
+
+  {
+    const task::list<int> counted(5, 3);
+    ASSERT_TRUE_MSG(counted.size() == 5 && counted.front() == 3, "list(count, value) with integral T")
+
+    std::vector<int> vector_std = {1, 2, 3, 4, 5};
+    task::list<int> list_task(vector_std.begin(), vector_std.end());
+    std::list<int> list_std(vector_std.begin(), vector_std.end());
+    ASSERT_EQUAL_MSG(list_task, list_std, "list(first, last)")
+
+    auto it_task = list_task.insert(std::next(list_task.cbegin(), 2), vector_std.begin(), vector_std.end());
+    auto it_std = list_std.insert(std::next(list_std.cbegin(), 2), vector_std.begin(), vector_std.end());
+    ASSERT_EQUAL_MSG(list_task, list_std, "list::insert(pos, first, last)")
+    ASSERT_TRUE_MSG(std::distance(list_task.begin(), it_task) == std::distance(list_std.begin(), it_std),
+                    "list::insert(pos, first, last) returns the first inserted element")
+
+    it_task = list_task.insert(list_task.cend(), 3, 7);
+    it_std = list_std.insert(list_std.cend(), 3, 7);
+    ASSERT_EQUAL_MSG(list_task, list_std, "list::insert(pos, count, value)")
+    ASSERT_TRUE_MSG(std::distance(list_task.begin(), it_task) == std::distance(list_std.begin(), it_std),
+                    "list::insert(pos, count, value) returns the first inserted element")
+
+    task::list<int> shorter(2, 0);
+    task::list<int> longer(100, 0);
+    shorter = list_task;
+    longer = list_task;
+    ASSERT_EQUAL_MSG(shorter, list_std, "copy assignment to a shorter list")
+    ASSERT_EQUAL_MSG(longer, list_std, "copy assignment to a longer list")
+  }
+
+  {
+    struct ThrowsOnCopy {
+      int value;
+      ThrowsOnCopy(int v) : value(v) {}
+      ThrowsOnCopy(const ThrowsOnCopy& other) : value(other.value) {
+        if (value == 3) throw value;
+      }
+    };
+
+    std::vector<ThrowsOnCopy> source;
+    source.reserve(4);
+    for (int i = 1; i <= 4; i++) source.emplace_back(i);
+    task::list<ThrowsOnCopy> list;
+    list.emplace_back(0);
+    bool thrown = false;
+    try {
+      list.insert(list.cend(), source.begin(), source.end());
+    } catch (int) {
+      thrown = true;
+    }
+    ASSERT_TRUE_MSG(thrown && list.size() == 1 && list.front().value == 0,
+                    "list::insert(pos, first, last) leaves the list unchanged on exception")
+  }
+
+  {
+    task::list<Immovable, CountingAllocator<Immovable>> list;
+    const size_t allocations_before = allocations_count;
+    list.emplace_back();
+    list.emplace_front();
+    list.emplace(std::next(list.begin()));
+    ASSERT_TRUE_MSG(list.size() == 3, "list::emplace builds values in place")
+    ASSERT_TRUE_MSG(allocations_count == allocations_before + 3, "one allocation per emplace")
+  }
+
+  {
+    const size_t allocations_before = allocations_count;
+    {
+      task::list<size_t, CountingAllocator<size_t>> list;
+      task::list<size_t, CountingAllocator<size_t>> list2 = std::move(list);
+      list = std::move(list2);
+      list.swap(list2);
+    }
+    ASSERT_TRUE_MSG(allocations_count == allocations_before, "empty list allocates nothing")
+
+    task::list<size_t> list_task;
+    std::list<size_t> list_std;
+    RandomFill(list_std, 100);
+    for (auto value : list_std) {
+      list_task.push_back(value);
+    }
+    ASSERT_TRUE_MSG(std::equal(list_task.rbegin(), list_task.rend(), list_std.rbegin(), list_std.rend()),
+                    "reverse iterator")
+  }
+
   {
     const size_t LIST_COUNT = 5;
     const size_t ITER_COUNT = 4000;
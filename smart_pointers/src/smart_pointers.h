@@ -1,9 +1,75 @@
 #pragma once
+#include <atomic>
+#include <memory>
+#include <new>
 #include <tuple>
 namespace task {
 
-template <typename T> class SharedPtr;
-template <typename T> class WeakPtr;
+// How a SharedPtr group counts its references. AtomicRefCount lets the
+// group be copied and released from several threads at once. PlainRefCount
+// skips the locked instructions, for groups that never leave one thread.
+struct AtomicRefCount {
+  using count_type = std::atomic<long>;
+
+  // A new reference is always made from an existing one, so incrementing
+  // needs no ordering.
+  static void increment(count_type &count) noexcept {
+    count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // For WeakPtr::lock: takes a reference only while the object is alive.
+  static bool increment_if_nonzero(count_type &count) noexcept {
+    long value = count.load(std::memory_order_relaxed);
+    while (value != 0) {
+      if (count.compare_exchange_weak(value, value + 1,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  // Returns the count before decrementing. acq_rel: every other owner's use
+  // of the object happens before the one that drops the last reference
+  // destroys it.
+  static long decrement(count_type &count) noexcept {
+    return count.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+  static long load(const count_type &count) noexcept {
+    return count.load(std::memory_order_relaxed);
+  }
+
+  static long load_acquire(const count_type &count) noexcept {
+    return count.load(std::memory_order_acquire);
+  }
+};
+
+struct PlainRefCount {
+  using count_type = long;
+
+  static void increment(count_type &count) noexcept { ++count; }
+
+  static bool increment_if_nonzero(count_type &count) noexcept {
+    if (count == 0)
+      return false;
+    ++count;
+    return true;
+  }
+
+  static long decrement(count_type &count) noexcept { return count--; }
+
+  static long load(const count_type &count) noexcept { return count; }
+
+  static long load_acquire(const count_type &count) noexcept { return count; }
+};
+
+template <typename T, typename Policy = AtomicRefCount> class SharedPtr;
+template <typename T, typename Policy = AtomicRefCount> class WeakPtr;
+
+template <typename T, typename Policy = AtomicRefCount, typename Alloc,
+          typename... Args>
+SharedPtr<T, Policy> AllocateShared(const Alloc &alloc, Args &&... args);
 
 template <typename T, typename D> class Ptr {
 public:
@@ -40,56 +106,137 @@ public:
   void operator()(T *p) const { delete p; }
 };
 
-template <typename T, typename D = DefaultDelete<T>> class ControlBlock {
+// The reference counts of a SharedPtr group. How the object is stored and
+// released is up to the derived block: dispose() ends the object's lifetime
+// when the last owner goes, destroy() frees the block when the last
+// WeakPtr goes too.
+template <typename Policy = AtomicRefCount> class ControlBlockBase {
 public:
-  using element_type = T;
-  using deleter_type = D;
-
-  ControlBlock(T *p) : _pointer{p} {}
+  ControlBlockBase() = default;
 
-  ControlBlock(T *p, D d) : _pointer{p, d} {}
+  ControlBlockBase(const ControlBlockBase &) = delete;
+  ControlBlockBase &operator=(const ControlBlockBase &) = delete;
 
-  ~ControlBlock() {}
+  void inc_ref() noexcept { Policy::increment(_use_count); }
 
-  void inc_ref() noexcept { ++_use_count; }
+  void inc_wref() noexcept { Policy::increment(_weak_use_count); }
 
-  void inc_wref() noexcept { ++_weak_use_count; }
+  bool try_inc_ref() noexcept {
+    return Policy::increment_if_nonzero(_use_count);
+  }
 
   void dec_ref() noexcept {
-    auto _ptr = _pointer.get_ptr();
-    auto &_deleter = _pointer.get_deleter();
-    if (--_use_count == 0) {
-      if (_ptr)
-        _deleter(_ptr);
+    if (Policy::decrement(_use_count) == 1) {
+      dispose();
       dec_wref();
     }
   }
 
   void dec_wref() noexcept {
-    if (--_weak_use_count == 0) {
-      delete this;
+    if (Policy::decrement(_weak_use_count) == 1) {
+      destroy();
     }
   }
 
-  long use_count() const noexcept { return _use_count; }
+  long use_count() const noexcept { return Policy::load(_use_count); }
 
-  bool unique() const noexcept { return _use_count == 1; }
+  bool unique() const noexcept { return use_count() == 1; }
 
   long weak_use_count() const noexcept {
-    return _weak_use_count - ((_use_count > 0) ? 1 : 0);
+    const long use_count = Policy::load(_use_count);
+    return Policy::load(_weak_use_count) - ((use_count > 0) ? 1 : 0);
   }
 
-  bool expired() const noexcept { return _use_count == 0; }
+  bool expired() const noexcept {
+    return Policy::load_acquire(_use_count) == 0;
+  }
+
+protected:
+  virtual ~ControlBlockBase() = default;
+
+  virtual void dispose() noexcept = 0;
+  virtual void destroy() noexcept = 0;
+
+private:
+  // The owners together hold one weak reference, dropped with the last of
+  // them, so the block outlives the object while WeakPtrs remain.
+  typename Policy::count_type _use_count{1};
+  typename Policy::count_type _weak_use_count{1};
+};
+
+// Owns an object allocated elsewhere and releases it through the deleter.
+// The block itself comes from Alloc, rebound to the block type.
+template <typename T, typename D = DefaultDelete<T>,
+          typename Policy = AtomicRefCount, typename Alloc = std::allocator<T>>
+class ControlBlock : public ControlBlockBase<Policy> {
+public:
+  using element_type = T;
+  using deleter_type = D;
+  using allocator_type = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<ControlBlock>;
+
+  ControlBlock(T *p, const D &d, const Alloc &alloc)
+      : _pointer{p, d}, _allocator(alloc) {}
 
   void *get_deleter() noexcept {
     return reinterpret_cast<void *>(std::addressof(_pointer.get_deleter()));
   }
 
+protected:
+  void dispose() noexcept override {
+    auto _ptr = _pointer.get_ptr();
+    auto &_deleter = _pointer.get_deleter();
+    if (_ptr)
+      _deleter(_ptr);
+  }
+
+  void destroy() noexcept override {
+    allocator_type allocator(_allocator);
+    this->~ControlBlock();
+    std::allocator_traits<allocator_type>::deallocate(allocator, this, 1);
+  }
+
 private:
-  long _use_count = 1;
-  long _weak_use_count = 1;
   Ptr<T, D> _pointer;
+  allocator_type _allocator;
 };
+
+// Holds the object itself, so that the object and its counts come from one
+// allocation of Alloc (see AllocateShared).
+template <typename T, typename Alloc, typename Policy = AtomicRefCount>
+class InlineControlBlock : public ControlBlockBase<Policy> {
+public:
+  using element_type = T;
+  using allocator_type =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
+  template <typename... Args>
+  explicit InlineControlBlock(const Alloc &alloc, Args &&... args)
+      : _allocator(alloc) {
+    std::allocator_traits<allocator_type>::construct(
+        _allocator, get(), std::forward<Args>(args)...);
+  }
+
+  T *get() noexcept { return reinterpret_cast<T *>(&_storage); }
+
+protected:
+  void dispose() noexcept override {
+    std::allocator_traits<allocator_type>::destroy(_allocator, get());
+  }
+
+  void destroy() noexcept override {
+    using block_allocator = typename std::allocator_traits<
+        Alloc>::template rebind_alloc<InlineControlBlock>;
+    block_allocator allocator(_allocator);
+    this->~InlineControlBlock();
+    std::allocator_traits<block_allocator>::deallocate(allocator, this, 1);
+  }
+
+private:
+  allocator_type _allocator;
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+};
+
 template <typename T, typename D = DefaultDelete<T>> class UniquePtr {
 public:
   using pointer = T *;
@@ -144,24 +291,45 @@ private:
   }
 };
 
-template <class T> class SharedPtr {
+// Policy is AtomicRefCount or PlainRefCount; pointers to one object must
+// all use the same policy.
+template <class T, class Policy> class SharedPtr {
 public:
-  template <typename U> friend class SharedPtr;
+  template <typename U, typename P> friend class SharedPtr;
 
-  template <typename U> friend class WeakPtr;
+  template <typename U, typename P> friend class WeakPtr;
+
+  template <typename U, typename P, typename Alloc, typename... Args>
+  friend SharedPtr<U, P> AllocateShared(const Alloc &alloc, Args &&... args);
 
   using element_type = typename SharedPtrAccess<T>::element_type;
-  using weak_type = WeakPtr<T>;
+  using weak_type = WeakPtr<T, Policy>;
+  using policy_type = Policy;
 
   constexpr SharedPtr() noexcept;
 
   template <typename U> explicit SharedPtr(U *p);
 
+  // p is released with d when the last owner goes. The control block is
+  // allocated from alloc; if that fails, d(p) is called before rethrowing.
+  template <typename U, typename Deleter> SharedPtr(U *p, Deleter d);
+
+  template <typename U, typename Deleter, typename Alloc>
+  SharedPtr(U *p, Deleter d, Alloc alloc);
+
   SharedPtr(const SharedPtr &sp) noexcept;
 
-  template <typename U> SharedPtr(SharedPtr<U> &&sp) noexcept;
+  template <typename U> SharedPtr(SharedPtr<U, Policy> &&sp) noexcept;
+
+  template <typename U> explicit SharedPtr(const WeakPtr<U, Policy> &wp);
+
+  // Aliasing: shares ownership with sp but points at p, typically a member
+  // of, or an element inside, the object sp owns.
+  template <typename U>
+  SharedPtr(const SharedPtr<U, Policy> &sp, element_type *p) noexcept;
 
-  template <typename U> explicit SharedPtr(const WeakPtr<U> &wp);
+  template <typename U>
+  SharedPtr(SharedPtr<U, Policy> &&sp, element_type *p) noexcept;
 
   ~SharedPtr();
 
@@ -169,7 +337,7 @@ public:
 
   SharedPtr &operator=(SharedPtr &&);
 
-  template <typename U> SharedPtr &operator=(SharedPtr<U> &&) noexcept;
+  template <typename U> SharedPtr &operator=(SharedPtr<U, Policy> &&) noexcept;
 
   void swap(SharedPtr &sp) noexcept;
 
@@ -186,35 +354,44 @@ public:
   long use_count() const noexcept;
 
 private:
+  // Empty if wp has expired; used by WeakPtr::lock.
+  template <typename U>
+  SharedPtr(const WeakPtr<U, Policy> &wp, std::nothrow_t) noexcept;
+
+  // Adopts one reference already counted in control_block.
+  SharedPtr(element_type *p, ControlBlockBase<Policy> *control_block) noexcept;
+
   element_type *_ptr;
-  ControlBlock<T> *_control_block;
+  ControlBlockBase<Policy> *_control_block;
 };
 
-template <class T> class WeakPtr {
+template <class T, class Policy> class WeakPtr {
 public:
-  template <typename U> friend class SharedPtr;
+  template <typename U, typename P> friend class SharedPtr;
 
-  template <typename U> friend class WeakPtr;
+  template <typename U, typename P> friend class WeakPtr;
 
   using element_type = typename std::remove_extent<T>::type;
 
   constexpr WeakPtr() noexcept;
 
-  template <class U> WeakPtr(SharedPtr<U> const &sp) noexcept;
+  template <class U> WeakPtr(SharedPtr<U, Policy> const &sp) noexcept;
 
   WeakPtr(WeakPtr const &wp) noexcept;
 
-  template <class U> WeakPtr(WeakPtr<U> const &wp) noexcept;
+  template <class U> WeakPtr(WeakPtr<U, Policy> const &wp) noexcept;
 
-  template <typename U> WeakPtr(WeakPtr<U> &&sp) noexcept;
+  template <typename U> WeakPtr(WeakPtr<U, Policy> &&sp) noexcept;
 
   ~WeakPtr();
 
   WeakPtr &operator=(const WeakPtr &wp) noexcept;
 
-  template <typename U> WeakPtr &operator=(const WeakPtr<U> &wp) noexcept;
+  template <typename U>
+  WeakPtr &operator=(const WeakPtr<U, Policy> &wp) noexcept;
 
-  template <typename U> WeakPtr &operator=(const SharedPtr<U> &sp) noexcept;
+  template <typename U>
+  WeakPtr &operator=(const SharedPtr<U, Policy> &sp) noexcept;
 
   void swap(WeakPtr &wp) noexcept;
 
@@ -222,14 +399,117 @@ public:
 
   bool expired() const noexcept;
 
-  SharedPtr<T> lock() const noexcept;
+  SharedPtr<T, Policy> lock() const noexcept;
 
 private:
   element_type *_ptr;
-  ControlBlock<T> *_control_block;
+  ControlBlockBase<Policy> *_control_block;
+};
+
+template <typename T> class IntrusivePtr;
+
+// The reference count of an object managed by IntrusivePtr, embedded in the
+// object itself: T derives from RefCounted<T>. When the last IntrusivePtr
+// lets go, the object is released through a default-constructed D, so T
+// must be allocated the way D expects (with new, for DefaultDelete).
+template <typename T, typename D = DefaultDelete<T>,
+          typename Policy = AtomicRefCount>
+class RefCounted {
+public:
+  using deleter_type = D;
+  using policy_type = Policy;
+
+  long use_count() const noexcept { return Policy::load(_use_count); }
+
+protected:
+  RefCounted() noexcept = default;
+
+  // A copy is a new object with owners of its own.
+  RefCounted(const RefCounted &) noexcept {}
+
+  RefCounted &operator=(const RefCounted &) noexcept { return *this; }
+
+  ~RefCounted() = default;
+
+private:
+  template <typename U> friend class IntrusivePtr;
+
+  void inc_ref() const noexcept { Policy::increment(_use_count); }
+
+  void dec_ref() const noexcept {
+    if (Policy::decrement(_use_count) == 1)
+      D()(static_cast<T *>(const_cast<RefCounted *>(this)));
+  }
+
+  mutable typename Policy::count_type _use_count{0};
 };
 
-// Your template function definitions may go here...
+// Shares an object through the count it embeds (see RefCounted): one
+// pointer wide and no allocation besides the object. The count can be
+// reached from a raw pointer, so an IntrusivePtr may be made from a plain
+// T* at any time; there is no weak pointer.
+template <typename T> class IntrusivePtr {
+public:
+  template <typename U> friend class IntrusivePtr;
+
+  using element_type = T;
+
+  constexpr IntrusivePtr() noexcept;
+
+  explicit IntrusivePtr(T *p) noexcept;
+
+  IntrusivePtr(const IntrusivePtr &ip) noexcept;
+
+  template <typename U> IntrusivePtr(const IntrusivePtr<U> &ip) noexcept;
+
+  IntrusivePtr(IntrusivePtr &&ip) noexcept;
+
+  template <typename U> IntrusivePtr(IntrusivePtr<U> &&ip) noexcept;
+
+  ~IntrusivePtr();
+
+  IntrusivePtr &operator=(const IntrusivePtr &ip) noexcept;
+
+  IntrusivePtr &operator=(IntrusivePtr &&ip) noexcept;
+
+  void swap(IntrusivePtr &ip) noexcept;
+
+  void reset() noexcept;
+
+  void reset(T *p) noexcept;
+
+  T *get() const noexcept;
+
+  T &operator*() const noexcept;
+
+  T *operator->() const noexcept;
+
+  long use_count() const noexcept;
+
+private:
+  T *_ptr;
+};
+
+// The object is built inside its control block: one allocation, through
+// alloc, for both.
+template <typename T, typename Policy, typename Alloc, typename... Args>
+SharedPtr<T, Policy> AllocateShared(const Alloc &alloc, Args &&... args);
+
+template <typename T, typename Policy = AtomicRefCount, typename... Args>
+SharedPtr<T, Policy> MakeShared(Args &&... args);
+
+// Casts that share ownership with sp. DynamicPointerCast yields an empty
+// pointer if the cast fails.
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> StaticPointerCast(const SharedPtr<U, Policy> &sp) noexcept;
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy>
+DynamicPointerCast(const SharedPtr<U, Policy> &sp) noexcept;
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> ConstPointerCast(const SharedPtr<U, Policy> &sp) noexcept;
+
 
 } // namespace task
 
@@ -66,151 +66,348 @@ void UniquePtr<T, D>::swap(UniquePtr &up) noexcept {
   swap(_pointer, up._pointer);
 }
 
-template <class T>
-constexpr SharedPtr<T>::SharedPtr() noexcept : _ptr{}, _control_block{} {}
+template <class T, class Policy>
+constexpr SharedPtr<T, Policy>::SharedPtr() noexcept
+    : _ptr{}, _control_block{} {}
 
-template <class T>
+template <class T, class Policy>
 template <typename U>
-SharedPtr<T>::SharedPtr(U *p)
-    : _ptr{p}, _control_block{new ControlBlock<U>{p}} {}
+SharedPtr<T, Policy>::SharedPtr(U *p)
+    : SharedPtr(p, DefaultDelete<U>(), std::allocator<U>()) {}
 
-template <class T>
-SharedPtr<T>::SharedPtr(const SharedPtr &sp) noexcept
+template <class T, class Policy>
+template <typename U, typename Deleter>
+SharedPtr<T, Policy>::SharedPtr(U *p, Deleter d)
+    : SharedPtr(p, std::move(d), std::allocator<U>()) {}
+
+template <class T, class Policy>
+template <typename U, typename Deleter, typename Alloc>
+SharedPtr<T, Policy>::SharedPtr(U *p, Deleter d, Alloc alloc)
+    : _ptr{p}, _control_block{} {
+  using block_type = ControlBlock<U, Deleter, Policy, Alloc>;
+  using block_allocator = typename block_type::allocator_type;
+  using block_traits = std::allocator_traits<block_allocator>;
+
+  block_type *block = nullptr;
+  try {
+    block_allocator allocator(alloc);
+    block = block_traits::allocate(allocator, 1);
+    try {
+      ::new (static_cast<void *>(block)) block_type(p, d, alloc);
+    } catch (...) {
+      block_traits::deallocate(allocator, block, 1);
+      throw;
+    }
+  } catch (...) {
+    d(p);
+    throw;
+  }
+  _control_block = block;
+}
+
+template <class T, class Policy>
+SharedPtr<T, Policy>::SharedPtr(
+    element_type *p, ControlBlockBase<Policy> *control_block) noexcept
+    : _ptr{p}, _control_block{control_block} {}
+
+template <class T, class Policy>
+SharedPtr<T, Policy>::SharedPtr(const SharedPtr &sp) noexcept
     : _ptr{sp._ptr}, _control_block{sp._control_block} {
   if (_control_block)
     _control_block->inc_ref();
 }
 
-template <class T>
+template <class T, class Policy>
 template <typename U>
-SharedPtr<T>::SharedPtr(SharedPtr<U> &&sp) noexcept
+SharedPtr<T, Policy>::SharedPtr(SharedPtr<U, Policy> &&sp) noexcept
     : _ptr{sp._ptr}, _control_block{sp._control_block} {
   sp._ptr = nullptr;
   sp._control_block = nullptr;
 }
-template <class T>
+template <class T, class Policy>
 template <typename U>
-SharedPtr<T>::SharedPtr(const WeakPtr<U> &wp)
-    : _ptr{wp._ptr}, _control_block{wp._control_block} {
-  _control_block->inc_ref();
+SharedPtr<T, Policy>::SharedPtr(const WeakPtr<U, Policy> &wp)
+    : SharedPtr(wp, std::nothrow) {
+  if (!_control_block)
+    throw std::bad_weak_ptr();
 }
-template <class T> SharedPtr<T>::~SharedPtr() {
+
+template <class T, class Policy>
+template <typename U>
+SharedPtr<T, Policy>::SharedPtr(const SharedPtr<U, Policy> &sp,
+                                element_type *p) noexcept
+    : _ptr{p}, _control_block{sp._control_block} {
+  if (_control_block)
+    _control_block->inc_ref();
+}
+
+template <class T, class Policy>
+template <typename U>
+SharedPtr<T, Policy>::SharedPtr(SharedPtr<U, Policy> &&sp,
+                                element_type *p) noexcept
+    : _ptr{p}, _control_block{sp._control_block} {
+  sp._ptr = nullptr;
+  sp._control_block = nullptr;
+}
+
+template <class T, class Policy>
+template <typename U>
+SharedPtr<T, Policy>::SharedPtr(const WeakPtr<U, Policy> &wp,
+                                std::nothrow_t) noexcept
+    : _ptr{}, _control_block{} {
+  if (wp._control_block && wp._control_block->try_inc_ref()) {
+    _ptr = wp._ptr;
+    _control_block = wp._control_block;
+  }
+}
+template <class T, class Policy> SharedPtr<T, Policy>::~SharedPtr() {
   if (_control_block)
     _control_block->dec_ref();
 }
-template <class T>
-SharedPtr<T> &SharedPtr<T>::operator=(const SharedPtr<T> &sp) {
+template <class T, class Policy>
+SharedPtr<T, Policy> &
+SharedPtr<T, Policy>::operator=(const SharedPtr<T, Policy> &sp) {
   SharedPtr{sp}.swap(*this);
   return *this;
 }
 
-template <class T> SharedPtr<T> &SharedPtr<T>::operator=(SharedPtr<T> &&sp) {
+template <class T, class Policy>
+SharedPtr<T, Policy> &
+SharedPtr<T, Policy>::operator=(SharedPtr<T, Policy> &&sp) {
   SharedPtr{std::move(sp)}.swap(*this);
   return *this;
 }
 
-template <class T> void SharedPtr<T>::swap(SharedPtr &sp) noexcept {
+template <class T, class Policy>
+void SharedPtr<T, Policy>::swap(SharedPtr &sp) noexcept {
   using std::swap;
   swap(_ptr, sp._ptr);
   swap(_control_block, sp._control_block);
 }
 
-template <class T> void SharedPtr<T>::reset() noexcept {
+template <class T, class Policy> void SharedPtr<T, Policy>::reset() noexcept {
   SharedPtr{}.swap(*this);
 }
 
-template <class T> template <typename U> void SharedPtr<T>::reset(U *p) {
+template <class T, class Policy>
+template <typename U>
+void SharedPtr<T, Policy>::reset(U *p) {
   SharedPtr{p}.swap(*this);
 }
 
-template <class T>
-typename SharedPtr<T>::element_type *SharedPtr<T>::get() const noexcept {
+template <class T, class Policy>
+typename SharedPtr<T, Policy>::element_type *
+SharedPtr<T, Policy>::get() const noexcept {
   { return _ptr; }
 }
-template <class T>
-typename SharedPtr<T>::element_type &SharedPtr<T>::operator*() const noexcept {
+template <class T, class Policy>
+typename SharedPtr<T, Policy>::element_type &
+SharedPtr<T, Policy>::operator*() const noexcept {
   return *_ptr;
 }
-template <class T>
-typename SharedPtr<T>::element_type *SharedPtr<T>::operator->() const noexcept {
+template <class T, class Policy>
+typename SharedPtr<T, Policy>::element_type *
+SharedPtr<T, Policy>::operator->() const noexcept {
   return _ptr;
 }
-template <class T> long SharedPtr<T>::use_count() const noexcept {
+template <class T, class Policy>
+long SharedPtr<T, Policy>::use_count() const noexcept {
   return (_control_block) ? _control_block->use_count() : 0;
 }
 
-template <class T>
-constexpr WeakPtr<T>::WeakPtr() noexcept : _ptr{}, _control_block{} {}
+template <class T, class Policy>
+constexpr WeakPtr<T, Policy>::WeakPtr() noexcept : _ptr{}, _control_block{} {}
 
-template <class T>
+template <class T, class Policy>
 template <class U>
-WeakPtr<T>::WeakPtr(const SharedPtr<U> &sp) noexcept
+WeakPtr<T, Policy>::WeakPtr(const SharedPtr<U, Policy> &sp) noexcept
     : _ptr{sp._ptr}, _control_block{sp._control_block} {
   if (_control_block)
     _control_block->inc_wref();
 }
 
-template <class T>
-WeakPtr<T>::WeakPtr(WeakPtr const &wp) noexcept
+template <class T, class Policy>
+WeakPtr<T, Policy>::WeakPtr(WeakPtr const &wp) noexcept
     : _ptr{wp._ptr}, _control_block{wp._control_block} {
   if (_control_block)
     _control_block->inc_wref();
 }
-template <class T>
+template <class T, class Policy>
 template <typename U>
-WeakPtr<T>::WeakPtr(WeakPtr<U> &&sp) noexcept
+WeakPtr<T, Policy>::WeakPtr(WeakPtr<U, Policy> &&sp) noexcept
     : _ptr{sp._ptr}, _control_block{sp._control_block} {
   sp._ptr = nullptr;
   sp._control_block = nullptr;
 }
 
-template <class T>
+template <class T, class Policy>
 template <class U>
-WeakPtr<T>::WeakPtr(const WeakPtr<U> &wp) noexcept
+WeakPtr<T, Policy>::WeakPtr(const WeakPtr<U, Policy> &wp) noexcept
     : _ptr{wp._ptr}, _control_block{wp._control_block} {
   if (_control_block)
     _control_block->inc_wref();
 }
 
-template <class T> WeakPtr<T>::~WeakPtr() {
+template <class T, class Policy> WeakPtr<T, Policy>::~WeakPtr() {
   if (_control_block)
     _control_block->dec_wref();
 }
-template <class T>
-WeakPtr<T> &WeakPtr<T>::operator=(const WeakPtr &wp) noexcept {
+template <class T, class Policy>
+WeakPtr<T, Policy> &WeakPtr<T, Policy>::operator=(const WeakPtr &wp) noexcept {
   WeakPtr{wp}.swap(*this);
   return *this;
 }
 
-template <class T>
+template <class T, class Policy>
 template <class U>
-WeakPtr<T> &WeakPtr<T>::operator=(const WeakPtr<U> &wp) noexcept {
+WeakPtr<T, Policy> &
+WeakPtr<T, Policy>::operator=(const WeakPtr<U, Policy> &wp) noexcept {
   WeakPtr{wp}.swap(*this);
   return *this;
 }
-template <class T>
+template <class T, class Policy>
 template <typename U>
-WeakPtr<T> &WeakPtr<T>::operator=(const SharedPtr<U> &sp) noexcept {
+WeakPtr<T, Policy> &
+WeakPtr<T, Policy>::operator=(const SharedPtr<U, Policy> &sp) noexcept {
   WeakPtr{sp}.swap(*this);
   return *this;
 }
 
-template <class T> void WeakPtr<T>::swap(WeakPtr &wp) noexcept {
+template <class T, class Policy>
+void WeakPtr<T, Policy>::swap(WeakPtr &wp) noexcept {
   using std::swap;
   swap(_ptr, wp._ptr);
   swap(_control_block, wp._control_block);
 }
-template <class T> long WeakPtr<T>::use_count() const noexcept {
+template <class T, class Policy>
+long WeakPtr<T, Policy>::use_count() const noexcept {
   return (_control_block) ? _control_block->use_count() : 0;
 }
-template <class T> bool WeakPtr<T>::expired() const noexcept {
+template <class T, class Policy>
+bool WeakPtr<T, Policy>::expired() const noexcept {
   return (_control_block) ? _control_block->expired() : false;
 }
-template <class T> SharedPtr<T> WeakPtr<T>::lock() const noexcept {
-  if (expired())
-    return SharedPtr<T>();
-  else
-    return SharedPtr<T>(*this);
+// Checking expired() first would race with the last owner letting go.
+template <class T, class Policy>
+SharedPtr<T, Policy> WeakPtr<T, Policy>::lock() const noexcept {
+  return SharedPtr<T, Policy>(*this, std::nothrow);
+}
+
+template <class T>
+constexpr IntrusivePtr<T>::IntrusivePtr() noexcept : _ptr{} {}
+
+template <class T> IntrusivePtr<T>::IntrusivePtr(T *p) noexcept : _ptr{p} {
+  if (_ptr)
+    _ptr->inc_ref();
+}
+
+template <class T>
+IntrusivePtr<T>::IntrusivePtr(const IntrusivePtr &ip) noexcept
+    : IntrusivePtr(ip._ptr) {}
+
+template <class T>
+template <typename U>
+IntrusivePtr<T>::IntrusivePtr(const IntrusivePtr<U> &ip) noexcept
+    : IntrusivePtr(ip._ptr) {}
+
+template <class T>
+IntrusivePtr<T>::IntrusivePtr(IntrusivePtr &&ip) noexcept : _ptr{ip._ptr} {
+  ip._ptr = nullptr;
+}
+
+template <class T>
+template <typename U>
+IntrusivePtr<T>::IntrusivePtr(IntrusivePtr<U> &&ip) noexcept : _ptr{ip._ptr} {
+  ip._ptr = nullptr;
+}
+
+template <class T> IntrusivePtr<T>::~IntrusivePtr() {
+  if (_ptr)
+    _ptr->dec_ref();
+}
+
+template <class T>
+IntrusivePtr<T> &IntrusivePtr<T>::operator=(const IntrusivePtr &ip) noexcept {
+  IntrusivePtr{ip}.swap(*this);
+  return *this;
+}
+
+template <class T>
+IntrusivePtr<T> &IntrusivePtr<T>::operator=(IntrusivePtr &&ip) noexcept {
+  IntrusivePtr{std::move(ip)}.swap(*this);
+  return *this;
+}
+
+template <class T> void IntrusivePtr<T>::swap(IntrusivePtr &ip) noexcept {
+  using std::swap;
+  swap(_ptr, ip._ptr);
+}
+
+template <class T> void IntrusivePtr<T>::reset() noexcept {
+  IntrusivePtr{}.swap(*this);
+}
+
+template <class T> void IntrusivePtr<T>::reset(T *p) noexcept {
+  IntrusivePtr{p}.swap(*this);
+}
+
+template <class T> T *IntrusivePtr<T>::get() const noexcept { return _ptr; }
+
+template <class T> T &IntrusivePtr<T>::operator*() const noexcept {
+  return *_ptr;
+}
+
+template <class T> T *IntrusivePtr<T>::operator->() const noexcept {
+  return _ptr;
+}
+
+template <class T> long IntrusivePtr<T>::use_count() const noexcept {
+  return (_ptr) ? _ptr->use_count() : 0;
+}
+
+template <typename T, typename Policy, typename Alloc, typename... Args>
+SharedPtr<T, Policy> AllocateShared(const Alloc &alloc, Args &&... args) {
+  using block_type = InlineControlBlock<T, Alloc, Policy>;
+  using block_allocator = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<block_type>;
+  using block_traits = std::allocator_traits<block_allocator>;
+
+  block_allocator allocator(alloc);
+  block_type *block = block_traits::allocate(allocator, 1);
+  try {
+    ::new (static_cast<void *>(block))
+        block_type(alloc, std::forward<Args>(args)...);
+  } catch (...) {
+    block_traits::deallocate(allocator, block, 1);
+    throw;
+  }
+  return SharedPtr<T, Policy>(block->get(),
+                              static_cast<ControlBlockBase<Policy> *>(block));
+}
+
+template <typename T, typename Policy, typename... Args>
+SharedPtr<T, Policy> MakeShared(Args &&... args) {
+  return AllocateShared<T, Policy>(std::allocator<T>(),
+                                   std::forward<Args>(args)...);
+}
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy>
+StaticPointerCast(const SharedPtr<U, Policy> &sp) noexcept {
+  return SharedPtr<T, Policy>(sp, static_cast<T *>(sp.get()));
+}
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy>
+DynamicPointerCast(const SharedPtr<U, Policy> &sp) noexcept {
+  if (T *p = dynamic_cast<T *>(sp.get()))
+    return SharedPtr<T, Policy>(sp, p);
+  return SharedPtr<T, Policy>();
+}
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> ConstPointerCast(const SharedPtr<U, Policy> &sp) noexcept {
+  return SharedPtr<T, Policy>(sp, const_cast<T *>(sp.get()));
 }
 
-} // namespace task
\ No newline at end of file
+} // namespace task
@@ -3,6 +3,8 @@
 #include <random>
 #include <algorithm>
 #include <vector>
+#include <thread>
+#include <atomic>
 #include "src/smart_pointers.h"
 
 using task::UniquePtr;
@@ -53,6 +55,53 @@ SharedPtr<Node> getCyclePtr(int cycleSize) {
 }
 
 
+// Records the block it hands out, and how many are outstanding.
+struct Arena {
+    size_t allocations = 0;
+    char* begin = nullptr;
+    size_t bytes = 0;
+};
+
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    Arena* arena;
+
+    explicit ArenaAllocator(Arena* arena): arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other): arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        ++arena->allocations;
+        arena->bytes = n * sizeof(T);
+        arena->begin = static_cast<char*>(::operator new(arena->bytes));
+        return reinterpret_cast<T*>(arena->begin);
+    }
+
+    void deallocate(T* p, size_t) {
+        --arena->allocations;
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+template <typename T>
+struct FailingAllocator {
+    using value_type = T;
+
+    FailingAllocator() = default;
+    template <typename U>
+    FailingAllocator(const FailingAllocator<U>&) {}
+
+    T* allocate(size_t) { throw std::bad_alloc(); }
+    void deallocate(T*, size_t) {}
+};
+
+
 void FailWithMsg(const std::string& msg, int line) {
     std::cerr << "Test failed!\n";
     std::cerr << "[Line " << line << "] "  << msg << std::endl;
@@ -193,4 +242,214 @@ int main() {
         }
     }
 
+    {
+        // Copies and locks from several threads must not lose counts.
+        struct Counted {
+            std::atomic<int>& destroyed;
+            ~Counted() { ++destroyed; }
+        };
+
+        std::atomic<int> destroyed{0};
+        const int THREADS = 4;
+        const int ROUNDS = 2'000;
+
+        for (int round = 0; round < ROUNDS; ++round) {
+            SharedPtr<Counted> shared(new Counted{destroyed});
+            WeakPtr<Counted> weak = shared;
+
+            std::vector<std::thread> threads;
+            for (int t = 0; t < THREADS; ++t) {
+                threads.emplace_back([local = shared, weak]() mutable {
+                    std::vector<SharedPtr<Counted>> copies(50, local);
+                    copies.clear();
+                    local.reset();
+                    SharedPtr<Counted> locked = weak.lock();
+                    ASSERT_TRUE(locked.get() == nullptr || locked.use_count() >= 1);
+                });
+            }
+            shared.reset();
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            ASSERT_TRUE(weak.expired());
+            ASSERT_TRUE(weak.lock().get() == nullptr);
+        }
+        ASSERT_TRUE_MSG(destroyed == ROUNDS, "every object is destroyed exactly once")
+    }
+
+    {
+        auto str = task::MakeShared<std::string>(3, 'x');
+        ASSERT_TRUE(*str == "xxx");
+        ASSERT_TRUE(str.use_count() == 1);
+
+        // The object goes with the last owner, the block with the last WeakPtr.
+        struct Counted {
+            int& destroyed;
+            explicit Counted(int& destroyed): destroyed(destroyed) {}
+            ~Counted() { ++destroyed; }
+        };
+        int destroyed = 0;
+        auto shared = task::MakeShared<Counted>(destroyed);
+        WeakPtr<Counted> weak = shared;
+        shared.reset();
+        ASSERT_TRUE_MSG(destroyed == 1, "MakeShared object outlived its owners");
+        ASSERT_TRUE(weak.expired());
+        ASSERT_TRUE(weak.lock().get() == nullptr);
+    }
+
+    {
+        // One allocation holds both the counts and the object.
+        Arena arena;
+        {
+            auto shared = task::AllocateShared<std::vector<int>>(
+                ArenaAllocator<std::vector<int>>(&arena), 5, 7);
+            ASSERT_TRUE(arena.allocations == 1);
+            ASSERT_TRUE(shared->size() == 5 && shared->back() == 7);
+            char* object = reinterpret_cast<char*>(shared.get());
+            ASSERT_TRUE_MSG(object >= arena.begin && object < arena.begin + arena.bytes,
+                            "AllocateShared object is outside its control block");
+        }
+        ASSERT_TRUE(arena.allocations == 0);
+    }
+
+    {
+        // Single-threaded groups can opt out of atomic counts.
+        using task::PlainRefCount;
+        static_assert(std::is_same<SharedPtr<int>::policy_type, task::AtomicRefCount>::value,
+                      "SharedPtr must default to atomic counts");
+
+        SharedPtr<std::string, PlainRefCount> first(new std::string("plain"));
+        WeakPtr<std::string, PlainRefCount> weak = first;
+        {
+            std::vector<SharedPtr<std::string, PlainRefCount>> copies(100, first);
+            ASSERT_TRUE(first.use_count() == 101);
+            ASSERT_TRUE(weak.lock()->size() == 5);
+        }
+        ASSERT_TRUE(first.use_count() == 1);
+        first.reset();
+        ASSERT_TRUE(weak.expired());
+        ASSERT_TRUE(weak.lock().get() == nullptr);
+
+        auto made = task::MakeShared<int, PlainRefCount>(42);
+        auto copy = made;
+        ASSERT_TRUE(*copy == 42 && made.use_count() == 2);
+    }
+
+    {
+        // The count lives in the object, so the pointer is a bare pointer.
+        struct Shape : task::RefCounted<Shape> {
+            int& destroyed;
+            explicit Shape(int& destroyed): destroyed(destroyed) {}
+            virtual ~Shape() { ++destroyed; }
+        };
+        struct Square : Shape {
+            using Shape::Shape;
+        };
+        static_assert(sizeof(task::IntrusivePtr<Shape>) == sizeof(Shape*),
+                      "IntrusivePtr must be one pointer wide");
+
+        int destroyed = 0;
+        {
+            task::IntrusivePtr<Square> square(new Square(destroyed));
+            task::IntrusivePtr<Shape> shape = square;
+            ASSERT_TRUE(shape.use_count() == 2);
+
+            // A raw pointer still reaches the count.
+            task::IntrusivePtr<Shape> again(square.get());
+            ASSERT_TRUE(again.use_count() == 3);
+
+            std::vector<task::IntrusivePtr<Shape>> copies(10, shape);
+            ASSERT_TRUE(shape.use_count() == 13);
+            copies.clear();
+
+            task::IntrusivePtr<Shape> moved = std::move(again);
+            ASSERT_TRUE(again.get() == nullptr && moved.use_count() == 3);
+            square.reset();
+            moved.reset();
+            ASSERT_TRUE(destroyed == 0 && shape.use_count() == 1);
+        }
+        ASSERT_TRUE_MSG(destroyed == 1, "IntrusivePtr object is destroyed exactly once");
+    }
+
+    {
+        // Both the object and its control block come from the arena.
+        Arena arena;
+        ArenaAllocator<int> alloc(&arena);
+        int* value = alloc.allocate(1);
+        *value = 5;
+        {
+            int deleted = 0;
+            SharedPtr<int> shared(value, [alloc, &deleted](int* p) mutable {
+                ++deleted;
+                alloc.deallocate(p, 1);
+            }, alloc);
+            ASSERT_TRUE(arena.allocations == 2);
+            ASSERT_TRUE(*shared == 5);
+
+            WeakPtr<int> weak = shared;
+            auto copy = shared;
+            shared.reset();
+            ASSERT_TRUE(deleted == 0);
+            copy.reset();
+            ASSERT_TRUE_MSG(deleted == 1, "the deleter runs with the last owner");
+            ASSERT_TRUE(arena.allocations == 1);
+        }
+        ASSERT_TRUE_MSG(arena.allocations == 0, "the control block goes back to its allocator");
+
+        // Without a control block the deleter still releases the object.
+        int released = 0;
+        bool thrown = false;
+        try {
+            SharedPtr<int> lost(new int(1), [&released](int* p) {
+                ++released;
+                delete p;
+            }, FailingAllocator<int>());
+        } catch (const std::bad_alloc&) {
+            thrown = true;
+        }
+        ASSERT_TRUE(thrown && released == 1);
+    }
+
+    {
+        // A view into a shared buffer keeps the whole buffer alive.
+        auto buffer = task::MakeShared<std::vector<int>>(16, 0);
+        SharedPtr<int> cell(buffer, buffer->data() + 3);
+        ASSERT_TRUE(buffer.use_count() == 2 && cell.use_count() == 2);
+        *cell = 7;
+        buffer.reset();
+        ASSERT_TRUE(*cell == 7 && cell.use_count() == 1);
+
+        int* next = cell.get() + 1;
+        SharedPtr<int> moved(std::move(cell), next);
+        ASSERT_TRUE(cell.get() == nullptr && moved.use_count() == 1);
+        ASSERT_TRUE(*(moved.get() - 1) == 7);
+    }
+
+    {
+        struct Base {
+            virtual ~Base() = default;
+        };
+        struct Derived : Base {
+            int value = 11;
+        };
+        struct Other : Base {};
+
+        SharedPtr<Base> base(new Derived());
+        auto derived = task::StaticPointerCast<Derived>(base);
+        ASSERT_TRUE(derived->value == 11 && base.use_count() == 2);
+
+        auto checked = task::DynamicPointerCast<Derived>(base);
+        ASSERT_TRUE(checked.get() == derived.get() && base.use_count() == 3);
+
+        auto other = task::DynamicPointerCast<Other>(base);
+        ASSERT_TRUE_MSG(other.get() == nullptr && other.use_count() == 0,
+                        "a failed dynamic cast must not share ownership");
+        ASSERT_TRUE(base.use_count() == 3);
+
+        auto constant = task::StaticPointerCast<const Derived>(derived);
+        auto mutated = task::ConstPointerCast<Derived>(constant);
+        mutated->value = 12;
+        ASSERT_TRUE(derived->value == 12 && base.use_count() == 5);
+    }
+
 }